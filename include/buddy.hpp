@@ -43,7 +43,7 @@ class Buddy : public List<Buddy>
                 };
         };
 
-        Spinlock        lock    { };
+        Spinlock        lock    { Spinlock::LOCK_BUDDY };
         signed long     max_idx { 0 };
         signed long     min_idx { 0 };
         mword           base    { 0 };
@@ -102,15 +102,15 @@ class Buddy : public List<Buddy>
         INIT
         Buddy (mword phys, mword virt, mword f_addr, size_t size);
 
-        static void *alloc (unsigned short ord, Quota &quota, Fill fill);
+        static void *alloc (unsigned short ord, Quota &quota, Fill fill, Quota::Kind = Quota::KIND_OTHER);
 
-        static void free (mword addr, Quota &quota);
+        static void free (mword addr, Quota &quota, Quota::Kind = Quota::KIND_OTHER);
 
      private:
 
-        void *_alloc (unsigned short ord, Quota &quota, Fill fill);
+        void *_alloc (unsigned short ord, Quota &quota, Fill fill, Quota::Kind = Quota::KIND_OTHER);
 
-        void _free (mword addr, Quota &quota);
+        void _free (mword addr, Quota &quota, Quota::Kind = Quota::KIND_OTHER);
 
      public:
 
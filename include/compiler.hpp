@@ -57,6 +57,9 @@
         #define ALWAYS_INLINE       __attribute__((always_inline))
         #define CPULOCAL            __attribute__((section (".cpulocal,\"w\",@nobits#")))
         #define CPULOCAL_HOT        __attribute__((section (".cpulocal.hot,\"w\",@nobits#")))
+        #define CPULOCAL_STAT       __attribute__((section (".cpulocal.stat,\"w\",@nobits#")))
+        #define CPULOCAL_LOCK       __attribute__((section (".cpulocal.stat.lock,\"w\",@nobits#")))
+        #define CPULOCAL_SYS        __attribute__((section (".cpulocal.stat.sys,\"w\",@nobits#")))
         #define FORMAT(X,Y)         __attribute__((format (printf, (X),(Y))))
         #define INIT                __attribute__((section (".init")))
         #define INITDATA            __attribute__((section (".initdata")))
@@ -21,6 +21,7 @@
 #pragma once
 
 #include <stdarg.h>
+#include "config.hpp"
 #include "initprio.hpp"
 #include "spinlock.hpp"
 
@@ -37,12 +38,16 @@ class Console
             FLAG_ZERO_PAD   = 1UL << 2,
         };
 
+        class Buffer;
+
         Console *next { nullptr };
 
         static Console *list;
         static Console *disabled;
         static Spinlock lock;
 
+        static Buffer ring[NUM_CPU];
+
         virtual void putc (int) = 0;
         virtual void reenable () = 0;
 
@@ -52,6 +57,8 @@ class Console
         FORMAT (2,0)
         void vprintf (char const *, va_list);
 
+        static void drain();
+
     protected:
         NOINLINE
         void enable()
@@ -66,11 +73,9 @@ class Console
         FORMAT (1,2) NORETURN
         static void panic (char const *, ...);
 
-        static void disable_all()
-        {
-            disabled = list;
-            list = nullptr;
-        }
+        static bool flush();
+
+        static void disable_all();
 
         static void enable_all()
         {
@@ -20,37 +20,77 @@
 
 #pragma once
 
+#include "buddy.hpp"
 #include "config.hpp"
 #include "console_vga.hpp"
 #include "cpu.hpp"
+#include "sysstat.hpp"
 
 class Counter
 {
     public:
-        static unsigned ipi[NUM_IPI]    CPULOCAL;
-        static unsigned lvt[NUM_LVT]    CPULOCAL;
-        static unsigned gsi[NUM_GSI]    CPULOCAL;
-        static unsigned exc[NUM_EXC]    CPULOCAL;
-        static unsigned vmi[NUM_VMI]    CPULOCAL;
-        static unsigned vtlb_gpf        CPULOCAL;
-        static unsigned vtlb_hpf        CPULOCAL;
-        static unsigned vtlb_fill       CPULOCAL;
-        static unsigned vtlb_flush      CPULOCAL;
-        static unsigned schedule        CPULOCAL;
-        static unsigned helping         CPULOCAL;
-        static uint64   cycles_idle     CPULOCAL;
+        /*
+         * Per-CPU statistics pages, exported read-only to the root PD
+         * via the HIP. The first page holds the event counters, the
+         * second one the lock and system-call statistics. The layout
+         * is part of the interface.
+         */
+        static unsigned const PAGES = 2;
+
+        struct Stats
+        {
+            uint64  cycles_idle;
+            uint64  schedule;
+            uint64  helping;
+            uint64  vtlb_gpf;
+            uint64  vtlb_hpf;
+            uint64  vtlb_fill;
+            uint64  vtlb_flush;
+            uint64  ipi[NUM_IPI];
+            uint64  lvt[NUM_LVT];
+            uint64  exc[NUM_EXC];
+            uint64  gsi[NUM_GSI];
+            uint64  vmi[NUM_VMI];
+        };
+
+        static_assert (sizeof (Stats) <= PAGE_SIZE, "Statistics exceed one page");
+        static_assert (sizeof (Spinlock::stats) + sizeof (Sysstat::stats) <= PAGE_SIZE, "Lock and system-call statistics exceed one page");
+
+        static Stats    stats           CPULOCAL_STAT;
+        static Paddr    phys;
+
+        static constexpr auto &ipi          = stats.ipi;
+        static constexpr auto &lvt          = stats.lvt;
+        static constexpr auto &gsi          = stats.gsi;
+        static constexpr auto &exc          = stats.exc;
+        static constexpr auto &vmi          = stats.vmi;
+        static constexpr auto &vtlb_gpf     = stats.vtlb_gpf;
+        static constexpr auto &vtlb_hpf     = stats.vtlb_hpf;
+        static constexpr auto &vtlb_fill    = stats.vtlb_fill;
+        static constexpr auto &vtlb_flush   = stats.vtlb_flush;
+        static constexpr auto &schedule     = stats.schedule;
+        static constexpr auto &helping      = stats.helping;
+        static constexpr auto &cycles_idle  = stats.cycles_idle;
+
+        INIT
+        static Paddr page (unsigned);
 
         static void dump();
 
+        /*
+         * Low word of a remote IPI counter, sufficient to observe a change
+         */
         ALWAYS_INLINE
-        static inline unsigned remote (unsigned c, unsigned i)
+        static inline mword remote (unsigned c, unsigned i)
         {
-            return *reinterpret_cast<volatile unsigned *>(reinterpret_cast<mword>(ipi + i) - CPU_LOCAL_DATA + HV_GLOBAL_CPUS + c * PAGE_SIZE);
+            return *reinterpret_cast<volatile mword *>(static_cast<Stats *>(Buddy::phys_to_ptr (phys + c * PAGES * PAGE_SIZE))->ipi + i);
         }
 
         template <unsigned D, unsigned B>
-        static void print (mword val, Console_vga::Color c, unsigned col)
+        static void print (uint64 v, Console_vga::Color c, unsigned col)
         {
+            mword val = static_cast<mword>(v);
+
             if (EXPECT_FALSE (Cpu::row))
                 for (unsigned i = 0; i < D; i++, val /= B)
                     Console_vga::con.put (Cpu::row, col - i, c, !i || val ? (val % B)["0123456789ABCDEF"] : ' ');
@@ -28,6 +28,8 @@ class Dpt : public Pte<Dpt, uint64, 4, 9, true, false>
         static mword ord;
         static bool  force_flush;
 
+        static Quota::Kind const KIND = Quota::KIND_DPT;
+
         static bool active() { return ord != ~0UL; }
 
         enum
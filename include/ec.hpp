@@ -30,8 +30,11 @@
 #include "regs.hpp"
 #include "sc.hpp"
 #include "timeout_hypercall.hpp"
+#include "tracebuf.hpp"
 #include "tss.hpp"
+#include "vmstat.hpp"
 #include "si.hpp"
+#include "sysstat.hpp"
 #include "cmdline.hpp"
 
 #include "stdio.hpp"
@@ -48,6 +51,34 @@ class Ec : public Kobject, public Refcount, public Queue<Sc>
     friend class Pt;
 
     private:
+        /*
+         * Proxy EC/SC pair executing cross-CPU portal calls on behalf of
+         * this EC. The pair stays allocated and is rebound per call.
+         */
+        struct Xcpu_proxy
+        {
+            enum State
+            {
+                NONE,       // not yet allocated
+                IDLE,       // only the owner reference is left
+                BUSY,       // enqueued, running or still leaving the remote CPU
+            };
+
+            Ec * ec { };
+            Sc * sc { };
+
+            ALWAYS_INLINE
+            inline State state() const
+            {
+                if (!sc)
+                    return NONE;
+
+                return sc->last_ref() ? IDLE : BUSY;
+            }
+        };
+
+        enum { XCPU_PROXIES = 2 };
+
         void        (*cont)() ALIGNED (16);
         Cpu_regs    regs { };
         Ec *        rcap { nullptr };
@@ -57,8 +88,9 @@ class Ec : public Kobject, public Refcount, public Queue<Sc>
         Ec *        prev    { };
         Ec *        next    { };
         Fpu *       fpu     { };
-        Ec *        ec_xcpu { };
-        Sc *        sc_xcpu { };
+        Vmstat *    vmstat  { };
+        Xcpu_proxy  xcpu_proxy[XCPU_PROXIES] { };
+        Sm *        sm_xcpu { };
 
         union {
             struct {
@@ -72,6 +104,9 @@ class Ec : public Kobject, public Refcount, public Queue<Sc>
         mword          user_utcb { };
 
         Sm *         xcpu_sm { };
+        Sm *         async_sm { };
+        mword        pt_count { };          // portals bound to this EC
+        mword        rev_next { };          // where an interrupted revoke resumes
         Pt *         pt_oom  { };
 
         uint64      tsc  { 0 };
@@ -142,17 +177,7 @@ class Ec : public Kobject, public Refcount, public Queue<Sc>
 
             e->flush_from_cpu();
 
-            if (e->ec_xcpu) {
-                auto ec = e->ec_xcpu;
-                e->ec_xcpu = nullptr;
-                Rcu::call(ec);
-            }
-
-            if (e->sc_xcpu) {
-                auto sc = e->sc_xcpu;
-                e->sc_xcpu = nullptr;
-                Rcu::call(sc);
-            }
+            e->xcpu_proxy_free();
         }
 
         ALWAYS_INLINE
@@ -286,6 +311,9 @@ class Ec : public Kobject, public Refcount, public Queue<Sc>
 
             current->time += t - current->tsc;
 
+            if (current != this)
+                Tracebuf::log (Tracebuf::EVT_SWITCH, reinterpret_cast<mword>(this), reinterpret_cast<mword>(current));
+
             current = this;
 
             current->tsc = t;
@@ -440,6 +468,9 @@ class Ec : public Kobject, public Refcount, public Queue<Sc>
         HOT NORETURN
         static void recv_user();
 
+        NORETURN
+        static void recv_vec();
+
         HOT NORETURN
         static void reply (void (*)() = nullptr, Sm * = nullptr);
 
@@ -449,6 +480,18 @@ class Ec : public Kobject, public Refcount, public Queue<Sc>
         HOT NORETURN
         static void sys_reply();
 
+        NORETURN
+        static void call_vec();
+
+        NORETURN
+        static void ret_call_vec();
+
+        NORETURN
+        static void call_async();
+
+        NORETURN
+        static void ret_call_async();
+
         NORETURN
         static void sys_create_pd();
 
@@ -508,6 +551,10 @@ class Ec : public Kobject, public Refcount, public Queue<Sc>
 
         void xcpu_clone(Ec &, uint16);
 
+        Xcpu_proxy *xcpu_proxy_select(unsigned);
+
+        void xcpu_proxy_free();
+
         template <void (*)()>
         NORETURN
         static void oom_xcpu_return();
@@ -28,6 +28,8 @@ class Ept : public Pte<Ept, uint64, 4, 9, false, false>
     public:
         static mword ord;
 
+        static Quota::Kind const KIND = Quota::KIND_NPT;
+
         enum
         {
             EPT_R   = 1UL << 0,
@@ -36,6 +36,8 @@ extern char FRAME_H;
 
 extern char PDBR;
 
+extern char TEXT_E;
+
 extern char LINK_P;
 extern char LINK_E;
 extern char LOAD_E;
@@ -51,7 +51,9 @@ class Hip_mem
             ACPI_XSDT   = -4u,
             MB2_FB      = -5u,
             HYP_LOG     = -6u,
-            SYSTAB      = -7u
+            SYSTAB      = -7u,
+            HYP_TRACE   = -8u,
+            HYP_STATS   = -9u
         };
 
         uint64  addr;
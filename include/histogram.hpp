@@ -0,0 +1,46 @@
+/*
+ * Cycle Histogram
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "bits.hpp"
+#include "compiler.hpp"
+#include "types.hpp"
+
+/*
+ * N logarithmic buckets of cycle counts. Bucket 0 covers less than
+ * 2^(S+1) cycles, bucket n the range [2^(n+S), 2^(n+S+1)) and the last
+ * bucket everything above.
+ */
+template <unsigned N, unsigned S>
+class Histogram
+{
+    public:
+        uint32  count[N];
+
+        ALWAYS_INLINE
+        static inline unsigned bucket (uint64 c)
+        {
+            c >>= S;
+
+            if (c >> (N - 1))
+                return N - 1;
+
+            return c ? static_cast<unsigned>(bit_scan_reverse (static_cast<mword>(c))) : 0;
+        }
+
+        ALWAYS_INLINE
+        inline void add (uint64 c) { count[bucket (c)]++; }
+};
@@ -44,6 +44,8 @@ class Hpt : public Pte<Hpt, mword, PTE_LEV, PTE_BPL, false, false>
     public:
         static mword ord;
 
+        static Quota::Kind const KIND = Quota::KIND_HPT;
+
         enum
         {
             HPT_P   = 1UL << 0,
@@ -33,7 +33,7 @@ class Ioapic : public List<Ioapic>
         unsigned const      id;
         Iommu::Interface   *iommu { nullptr };
         uint16              rid;
-        Spinlock            lock { };
+        Spinlock            lock { Spinlock::LOCK_IOAPIC };
         mword               saved_entries { };
 
         static Ioapic *     list;
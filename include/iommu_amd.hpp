@@ -82,7 +82,7 @@ class Iommu::Amd : public Iommu::Interface, public List<Amd>
         uint64            cmd_base   { 0 };
         uint64            event_base { 0 };
 
-        Spinlock          lock { };
+        Spinlock          lock { Spinlock::LOCK_IOMMU };
 
         uint16 const      iommu_rid;
         bool const        efeat_valid;
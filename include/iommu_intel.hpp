@@ -107,7 +107,7 @@ class Dmar : public Iommu::Interface, public List<Dmar>
         uint64              ecap { 0 };
         Dmar_qi *           invq;
         unsigned            invq_idx;
-        Spinlock            lock { };
+        Spinlock            lock { Spinlock::LOCK_IOMMU };
 
         static Dmar_ctx *   ctx;
         static Dmar_irt *   irt;
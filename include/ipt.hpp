@@ -24,6 +24,8 @@ class Ipt : public Pte<Ipt, uint64, 4, 9, true, true>
     public:
         static mword ord;
 
+        static Quota::Kind const KIND = Quota::KIND_DPT;
+
         static bool active() { return ord != ~0UL; }
 
         enum
@@ -26,6 +26,8 @@
 #include "msr.hpp"
 #include "x86.hpp"
 
+class Exc_regs;
+
 class Lapic
 {
     private:
@@ -97,7 +99,7 @@ class Lapic
         static inline void error_handler();
 
         ALWAYS_INLINE
-        static inline void perfm_handler();
+        static inline void perfm_handler (Exc_regs const *);
 
         ALWAYS_INLINE
         static inline void therm_handler();
@@ -164,8 +166,11 @@ class Lapic
 
         static void send_ipi (unsigned, unsigned, Delivery_mode = DLV_FIXED, Shorthand = DSH_NONE);
 
+        REGPARM (2)
+        static void lvt_vector (unsigned, Exc_regs const * = nullptr);
+
         REGPARM (1)
-        static void lvt_vector (unsigned) asm ("lvt_vector");
+        static void lvt_handler (Exc_regs const *) asm ("lvt_handler");
 
         REGPARM (1)
         static void ipi_vector (unsigned) asm ("ipi_vector");
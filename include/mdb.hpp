@@ -27,7 +27,14 @@
 
 class Space;
 
-class Mdb : public Avl, public Rcu_elem
+/*
+ * One node per delegated region. The layout is kept dense because fine
+ * grained delegations (e.g. guest memory at 4K) create millions of them:
+ * the Avl base follows the Rcu_elem base so that the lock and depth fill
+ * its tail padding, and the attributes and small immutable properties are
+ * bytes. On x86_64 a node plus its slab link fits 128 bytes.
+ */
+class Mdb : public Rcu_elem, public Avl
 {
     private:
         static Spinlock     lock;
@@ -35,18 +42,20 @@ class Mdb : public Avl, public Rcu_elem
         bool alive() const { return prev->next == this && next->prev == this; }
 
     public:
-        Spinlock        node_lock { };
+        Spinlock        node_lock { Spinlock::LOCK_MDB_NODE };
         uint16    const dpth;
         Mdb *           prev;
         Mdb *           next;
         Mdb *           prnt;
+        Mdb *           pred;   /* address-ordered neighbours in the space, pred == this if not in the tree */
+        Mdb *           succ;
         Space *   const space;
         mword     const node_phys;
         mword     const node_base;
-        mword     const node_order;
-        mword           node_attr;
-        mword     const node_type;
-        mword     const node_sub;
+        uint8           node_attr;
+        uint8     const node_order;
+        uint8     const node_type;
+        uint8     const node_sub;
 
         ALWAYS_INLINE
         inline bool larger (Mdb *x) const { return  node_base > x->node_base; }
@@ -55,17 +64,26 @@ class Mdb : public Avl, public Rcu_elem
         inline bool equal  (Mdb *x) const { return (node_base ^ x->node_base) >> max (node_order, x->node_order) == 0; }
 
         NOINLINE
-        explicit Mdb (Space *s, mword p, mword b, mword a, void (*f)(Rcu_elem *), void (*pf)(Rcu_elem *) = nullptr) : Rcu_elem (f, pf), dpth (0), prev (this), next (this), prnt (nullptr), space (s), node_phys (p), node_base (b), node_order (0), node_attr (a), node_type (0), node_sub (0) {}
+        explicit Mdb (Space *s, mword p, mword b, mword a, void (*f)(Rcu_elem *), void (*pf)(Rcu_elem *) = nullptr) : Rcu_elem (f, pf), dpth (0), prev (this), next (this), prnt (nullptr), pred (this), succ (nullptr), space (s), node_phys (p), node_base (b), node_attr (static_cast<uint8>(a)), node_order (0), node_type (0), node_sub (0) {}
 
         NOINLINE
-        explicit Mdb (Space *s, void (*f)(Rcu_elem *), mword p, mword b, mword o = 0, mword a = 0, mword t = 0, mword sub = 0, uint16 depth = 0) : Rcu_elem (f), dpth (depth), prev (this), next (this), prnt (nullptr), space (s), node_phys (p), node_base (b), node_order (o), node_attr (a), node_type (t), node_sub (sub) {}
-
-        static Mdb *lookup (Avl *tree, mword base, bool next)
+        explicit Mdb (Space *s, void (*f)(Rcu_elem *), mword p, mword b, mword o = 0, mword a = 0, mword t = 0, mword sub = 0, uint16 depth = 0) : Rcu_elem (f), dpth (depth), prev (this), next (this), prnt (nullptr), pred (this), succ (nullptr), space (s), node_phys (p), node_base (b), node_attr (static_cast<uint8>(a)), node_order (static_cast<uint8>(o)), node_type (static_cast<uint8>(t)), node_sub (static_cast<uint8>(sub)) {}
+
+        /*
+         * A lockless walk may race with a rotation, so its depth is bounded
+         * by the height of a valid AVL tree. The caller detects the race
+         * and retries.
+         */
+        static Mdb *lookup (Avl *tree, mword base, bool next, bool lockless = false)
         {
             Mdb *n = nullptr;
             bool d;
+            unsigned depth = 0;
+
+            for (Mdb *m = static_cast<Mdb *>(tree); m; m = static_cast<Mdb *>(lockless ? ACCESS_ONCE (m->lnk[d]) : m->lnk[d])) {
 
-            for (Mdb *m = static_cast<Mdb *>(tree); m; m = static_cast<Mdb *>(m->lnk[d])) {
+                if (lockless && ++depth > 2 * sizeof (mword) * 8)
+                    return nullptr;
 
                 if ((m->node_base ^ base) >> m->node_order == 0)
                     return m;
@@ -77,7 +95,10 @@ class Mdb : public Avl, public Rcu_elem
             return n;
         }
 
-        bool insert_node (Mdb *, mword);
+        ALWAYS_INLINE
+        inline bool linked() const { return ACCESS_ONCE (pred) != this; }
+
+        bool insert_node (Mdb *, mword, mword = 0);
         void demote_node (mword);
         bool remove_node(bool = true);
 
@@ -89,3 +110,7 @@ class Mdb : public Avl, public Rcu_elem
 
         template <typename T> void destroy (T *, Quota &, Slab_cache &);
 };
+
+#if defined(__x86_64__) && !defined(LOCK_STATS)
+static_assert (sizeof (Mdb) + sizeof (mword) <= 128, "Unsupported size of MDB node");
+#endif
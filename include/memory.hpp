@@ -49,6 +49,7 @@
 
 #define BUDDY_V_MAX     (HV_GLOBAL_CPUS - 0x400000)
 
+#define CPU_LOCAL_STAT  (SPC_LOCAL - PAGE_SIZE * 9)
 #define CPU_LOCAL_STCK  (SPC_LOCAL - PAGE_SIZE * 6)
 #define CPU_LOCAL_APIC  (SPC_LOCAL - PAGE_SIZE * 4)
 #define CPU_LOCAL_DATA  (SPC_LOCAL - PAGE_SIZE * 2)
@@ -48,6 +48,7 @@ class Msr
             IA32_FEATURE_CONTROL    = 0x3a,
             IA32_BIOS_SIGN_ID       = 0x8b,
             IA32_SMM_MONITOR_CTL    = 0x9b,
+            IA32_PMC0               = 0xc1,
             MSR_FSB_FREQ            = 0xcd,
             MSR_PLATFORM_INFO       = 0xce,
             IA32_MPERF              = 0xe7,
@@ -59,6 +60,7 @@ class Msr
             IA32_MCG_CAP            = 0x179,
             IA32_MCG_STATUS         = 0x17a,
             IA32_MCG_CTL            = 0x17b,
+            IA32_PERFEVTSEL0        = 0x186,
             IA32_THERM_INTERRUPT    = 0x19b,
             IA32_THERM_STATUS       = 0x19c,
             IA32_MISC_ENABLE        = 0x1a0,
@@ -73,6 +75,9 @@ class Msr
             IA32_MTRR_FIX4K_BASE    = 0x268,
             IA32_CR_PAT             = 0x277,
             IA32_MTRR_DEF_TYPE      = 0x2ff,
+            IA32_PERF_GLOBAL_STATUS = 0x38e,
+            IA32_PERF_GLOBAL_CTRL   = 0x38f,
+            IA32_PERF_GLOBAL_OVF    = 0x390,
 
             IA32_MCI_CTL            = 0x400,
             IA32_MCI_STATUS         = 0x401,
@@ -153,6 +158,8 @@ class Msr
             IA32_KERNEL_GS_BASE     = 0xc0000102,
             IA32_TSC_AUX            = 0xc0000103,
 
+            AMD_PERF_CTL0           = 0xc0010000,
+            AMD_PERF_CTR0           = 0xc0010004,
             AMD_IPMR                = 0xc0010055,
             AMD_PSTATE_LIMIT        = 0xc0010061,
             AMD_PSTATE_CTRL         = 0xc0010062,
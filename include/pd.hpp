@@ -65,6 +65,15 @@ class Pd : public Kobject, public Refcount, public Space_mem, public Space_pio,
             }
         }
 
+        /* TLB and IOMMU flushes collected while delegating a batch of items */
+        enum
+        {
+            FLUSH_TLB   = 1U << 0,
+            FLUSH_IOMMU = 1U << 1,
+        };
+
+        Spinlock cow_lock { Spinlock::LOCK_COW };
+
         uint16 rids[7];
         uint16 rids_u  { 0 };
 
@@ -139,13 +148,53 @@ class Pd : public Kobject, public Refcount, public Space_mem, public Space_pio,
         bool delegate (Pd *, mword, mword, mword, mword, mword = 0, char const * = nullptr);
 
         template <typename>
-        void revoke (mword, mword, mword, bool, bool);
+        bool revoke (mword, mword, mword, bool, bool, mword * = nullptr);
 
         void xfer_items (Pd *, Crd, Crd, Xfer *, Xfer *, unsigned long);
 
         void xlt_crd (Pd *, Crd, Crd &);
-        void del_crd (Pd *, Crd, Crd &, mword = 0, mword = 0);
-        void rev_crd (Crd, bool, bool, bool);
+        void del_crd (Pd *, Crd, Crd &, mword, mword, mword &);
+        void flush_deferred (mword);
+
+        ALWAYS_INLINE
+        inline void del_crd (Pd *pd, Crd del, Crd &crd, mword sub = 0, mword hot = 0)
+        {
+            mword flush = 0;
+
+            del_crd (pd, del, crd, sub, hot, flush);
+            flush_deferred (flush);
+        }
+        bool rev_crd (Crd, bool, bool, bool, mword * = nullptr);
+
+        bool cow_fault (mword);
+
+        enum Merge { MERGE_BAD, MERGE_OOM, MERGE_DIFF, MERGE_DONE };
+
+        Merge merge_page (Pd *, mword, mword);
+
+        mword harvest (mword, mword, bool, Utcb *);
+
+        /* kernel memory of the PD in pages, by category */
+        enum Kmem
+        {
+            KMEM_EC,
+            KMEM_SC,
+            KMEM_PT,
+            KMEM_SM,
+            KMEM_MDB,
+            KMEM_FPU,
+            KMEM_HPT,
+            KMEM_LOC,
+            KMEM_NPT,
+            KMEM_DPT,
+            KMEM_VTLB,
+            KMEM_UTCB,
+            KMEM_VCPU,
+            KMEM_OTHER,
+            KMEM_MAX,
+        };
+
+        void kmem (mword (&)[KMEM_MAX]);
 
         void assign_rid(uint16 r);
 
@@ -0,0 +1,73 @@
+/*
+ * Performance Monitoring Unit (PMU) Sampling
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "compiler.hpp"
+#include "memory.hpp"
+#include "types.hpp"
+
+class Exc_regs;
+class Utcb;
+
+/*
+ * Counter overflow sampling with the first general-purpose counter of
+ * the current CPU. Samples go into a per-CPU ring that is drained from
+ * an EC running on the same CPU.
+ */
+class Pmu
+{
+    public:
+        static unsigned const DEPTH = 3;
+
+        struct Sample
+        {
+            uint64  tsc;
+            uint64  rip;
+            uint64  cs;
+            uint64  ec;
+            uint64  pd;
+            uint64  frame[DEPTH];
+        };
+
+    private:
+        enum
+        {
+            SEL_OS      = 1UL << 17,
+            SEL_INT     = 1UL << 20,
+            SEL_EN      = 1UL << 22,
+        };
+
+        static unsigned const SAMPLES = PAGE_SIZE / sizeof (Sample);
+
+        static Sample * ring    CPULOCAL;
+        static unsigned head    CPULOCAL;
+        static unsigned tail    CPULOCAL;
+        static unsigned lost    CPULOCAL;
+        static unsigned depth   CPULOCAL;
+        static unsigned version CPULOCAL;
+        static uint64   period  CPULOCAL;
+
+        static bool supported();
+        static bool rearm();
+        static void stop();
+
+        static void frames (Sample &, mword);
+
+    public:
+        static bool config (mword, mword, mword);
+        static void sample (Exc_regs const *);
+        static unsigned drain (Utcb *, unsigned &);
+};
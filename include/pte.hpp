@@ -31,7 +31,7 @@ class Pte
     protected:
         E val;
 
-        P *walk (Quota &quota, E, unsigned long, bool = true);
+        P *walk (Quota &quota, E, unsigned long, bool = true, Quota::Kind = P::KIND);
 
         ALWAYS_INLINE
         inline bool present() const { return val & P::PTE_P; }
@@ -60,9 +60,9 @@ class Pte
         }
 
         ALWAYS_INLINE
-        static inline void *operator new (size_t, Quota &quota)
+        static inline void *operator new (size_t, Quota &quota, Quota::Kind k)
         {
-            void *p = Buddy::allocator.alloc (0, quota, Buddy::FILL_0);
+            void *p = Buddy::allocator.alloc (0, quota, Buddy::FILL_0, k);
 
             if (F)
                 flush (p, PAGE_SIZE);
@@ -71,9 +71,11 @@ class Pte
         }
 
         ALWAYS_INLINE
-        static inline void destroy(Pte *obj, Quota &quota) { obj->~Pte(); Buddy::allocator.free (reinterpret_cast<mword>(obj), quota); }
+        static inline void destroy(Pte *obj, Quota &quota, Quota::Kind k) { obj->~Pte(); Buddy::allocator.free (reinterpret_cast<mword>(obj), quota, k); }
 
-        void free_up (Quota &quota, unsigned l, P *, mword, bool (*) (Paddr, mword, unsigned), bool (*) (unsigned, mword));
+        void free_up (Quota &quota, unsigned l, P *, mword, bool (*) (Paddr, mword, unsigned), bool (*) (unsigned, mword), Quota::Kind);
+
+        static mword count (unsigned l, P const *, mword, bool (*) (Paddr, mword, unsigned), bool (*) (unsigned, mword));
 
     public:
 
@@ -100,13 +102,17 @@ class Pte
         static inline unsigned max() { return L; }
 
         ALWAYS_INLINE
-        inline E root (Quota &quota, mword l = L - 1) { return Buddy::ptr_to_phys (walk (quota, 0, l)); }
+        inline E root (Quota &quota, mword l = L - 1, Quota::Kind k = P::KIND) { return Buddy::ptr_to_phys (walk (quota, 0, l, true, k)); }
 
         size_t lookup (E, Paddr &, mword &);
 
-        bool update (Quota &quota, E, mword, E, E, Type = TYPE_UP);
+        size_t harvest (E, E, bool &);
+
+        bool update (Quota &quota, E, mword, E, E, Type = TYPE_UP, Quota::Kind = P::KIND);
+
+        mword pages (bool (*) (Paddr, mword, unsigned) = nullptr, bool (*) (unsigned, mword) = nullptr) const;
 
-        void clear (Quota &quota, bool (*) (Paddr, mword, unsigned) = nullptr, bool (*) (unsigned, mword) = nullptr);
+        void clear (Quota &quota, bool (*) (Paddr, mword, unsigned) = nullptr, bool (*) (unsigned, mword) = nullptr, Quota::Kind = P::KIND);
 
         bool check(Quota_guard &qg, mword o) { return qg.check(o / (4096 / sizeof(E)) + L); }
 };
@@ -26,8 +26,24 @@ class Quota
 {
     friend class Buddy;
 
+    public:
+        /*
+         * Kernel memory accounted separately when it is charged, so that
+         * it can be reported without walking the PD
+         */
+        enum Kind
+        {
+            KIND_UTCB,
+            KIND_VCPU,
+            KIND_VTLB,
+            KIND_HPT,
+            KIND_NPT,
+            KIND_DPT,
+            KIND_OTHER,
+        };
+
     private:
-        Spinlock lock { };
+        Spinlock lock { Spinlock::LOCK_QUOTA };
 
         mword used;
         mword over;
@@ -35,22 +51,30 @@ class Quota
         mword upli;
         mword notr;
 
+        mword kind[KIND_OTHER];
+
     public:
 
         static Quota init;
 
-        Quota () : used(0), over(0), upli(0), notr(0) { }
+        Quota () : used(0), over(0), upli(0), notr(0), kind() { }
 
-        void alloc(mword p)
+        void alloc(mword p, Kind k = KIND_OTHER)
         {
             Lock_guard <Spinlock> guard (lock);
             used += p;
+
+            if (k != KIND_OTHER)
+                kind[k] += p;
         }
 
-        void free(mword p)
+        void free(mword p, Kind k = KIND_OTHER)
         {
             Lock_guard <Spinlock> guard (lock);
 
+            if (k != KIND_OTHER)
+                kind[k] -= min (kind[k], p);
+
             if (p <= used) {
                 used -= p;
                 return;
@@ -63,6 +87,8 @@ class Quota
 
         mword usage() { return used; }
 
+        mword usage (Kind k) { return kind[k]; }
+
         static void boot(Quota &kern, Quota &root)
         {
             kern.upli   = kern.used;
@@ -71,13 +97,18 @@ class Quota
 
         void free_up(Quota &to)
         {
-            mword l, u, o;
+            mword l, u, o, k[KIND_OTHER];
             {
                 Lock_guard <Spinlock> guard (lock);
                 l = upli;
                 u = used;
                 o = over;
                 upli = over = used = 0;
+
+                for (unsigned i = 0; i < KIND_OTHER; i++) {
+                    k[i] = kind[i];
+                    kind[i] = 0;
+                }
             }
 
             Lock_guard <Spinlock> guard (to.lock);
@@ -85,6 +116,9 @@ class Quota
             to.upli += l;
             to.over += o;
 
+            for (unsigned i = 0; i < KIND_OTHER; i++)
+                to.kind[i] += k[i];
+
             if (to.over && to.used) {
                 mword s = min (to.used, to.over);
                 to.used -= s;
@@ -98,6 +98,23 @@ class Sys_regs
 
         ALWAYS_INLINE
         inline void set_sp (mword sp) { ARG_SP = sp; }
+
+        /*
+         * Message words of a register-only IPC, all argument registers
+         * except the one carrying selector, flags and status.
+         */
+        ALWAYS_INLINE
+        inline void copy_msg (Sys_regs const &src)
+        {
+            ARG_2 = src.ARG_2;
+            ARG_3 = src.ARG_3;
+            ARG_4 = src.ARG_4;
+            ARG_5 = src.ARG_5;
+#ifdef __x86_64__
+            r9    = src.r9;
+            r10   = src.r10;
+#endif
+        }
 };
 
 class Exc_regs : public Sys_regs
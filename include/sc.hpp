@@ -23,6 +23,7 @@
 #pragma once
 
 #include "compiler.hpp"
+#include "histogram.hpp"
 
 class Ec;
 
@@ -39,15 +40,20 @@ class Sc : public Kobject, public Refcount
         uint64         time    { 0 };
         uint64         time_m  { 0 };
 
+        /* Cycles from wake-up until the SC was dispatched */
+        uint64         latency_max { 0 };
+        Histogram<16, 10> latency  { };
+
         static unsigned const priorities = 128;
 
     private:
         uint64 left;
         Sc *prev { nullptr }, *next { nullptr };
         uint64 tsc { 0 };
+        uint64 wake { 0 };
 
         static struct Rq {
-            Spinlock    lock { };
+            Spinlock    lock { Spinlock::LOCK_RQ };
             Sc *        queue { nullptr };
         } rq CPULOCAL;
 
@@ -73,6 +79,8 @@ class Sc : public Kobject, public Refcount
         static uint64   long_loop   CPULOCAL;
         static uint64   cross_time[NUM_CPU];
         static uint64   killed_time[NUM_CPU];
+        static uint64   wait_time   CPULOCAL;
+        static uint64   wait_count  CPULOCAL;
 
         static unsigned const default_prio = 1;
         static unsigned const default_quantum = 10000;
@@ -88,6 +96,13 @@ class Sc : public Kobject, public Refcount
             return reinterpret_cast<typeof rq *>(reinterpret_cast<mword>(&rq) - CPU_LOCAL_DATA + HV_GLOBAL_CPUS + c * PAGE_SIZE);
         }
 
+        /* run-queue wait statistics of another CPU */
+        ALWAYS_INLINE
+        static inline uint64 remote (uint64 const &v, unsigned long c)
+        {
+            return *reinterpret_cast<volatile uint64 *>(reinterpret_cast<mword>(&v) - CPU_LOCAL_DATA + HV_GLOBAL_CPUS + c * PAGE_SIZE);
+        }
+
         void remote_enqueue(bool = true);
 
         static void rrq_handler();
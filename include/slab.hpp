@@ -28,7 +28,7 @@ class Slab;
 class Slab_cache
 {
     private:
-        Spinlock    lock { };
+        Spinlock    lock { Spinlock::LOCK_SLAB };
         Slab *      curr;
         Slab *      head;
 
@@ -44,6 +44,7 @@ class Slab_cache
         unsigned long size; // Size of an element
         unsigned long buff; // Size of an element buffer (includes link field)
         unsigned long elem; // Number of elements
+        unsigned long pages;// Number of slabs
 
         Slab_cache (unsigned long elem_size, unsigned elem_align);
         ~Slab_cache () { assert (!head && !curr); }
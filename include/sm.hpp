@@ -25,11 +25,31 @@
 #include "ec.hpp"
 #include "si.hpp"
 
+/*
+ * Shared ring of a channel SM. The producer advances head, the consumer
+ * advances tail; the remainder of the page is the ring buffer.
+ */
+class Chan_ring
+{
+    public:
+        mword head, tail;
+};
+
 class Sm : public Kobject, public Refcount, public Queue<Ec>, public Queue<Si>, public Si
 {
     private:
         mword counter;
 
+        Pd *        chan_pd   { nullptr };
+        mword       chan_addr { 0 };
+        Chan_ring * chan_ring { nullptr };
+
+        void chan_unmap();
+        void chan_free();
+
+        Sm(const Sm&);
+        Sm &operator = (Sm const &);
+
         static void free (Rcu_elem * a) {
             Sm * sm = static_cast <Sm *>(a);
 
@@ -47,6 +67,15 @@ class Sm : public Kobject, public Refcount, public Queue<Ec>, public Queue<Si>,
             }
         }
 
+        /* runs in the context that retires the SM, before the grace period */
+        static void pre_free (Rcu_elem * a)
+        {
+            Sm * sm = static_cast <Sm *>(a);
+
+            if (sm->chan_ring)
+                sm->chan_unmap();
+        }
+
     public:
 
         mword reset(bool l = false) {
@@ -62,6 +91,29 @@ class Sm : public Kobject, public Refcount, public Queue<Ec>, public Queue<Si>,
         {
             while (!counter)
                 up (Ec::sys_finish<Sys_regs::BAD_CAP, true>);
+
+            if (chan_ring)
+                chan_free();
+        }
+
+        bool chan_setup (Pd *, mword);
+
+        ALWAYS_INLINE
+        inline bool channel() const { return chan_ring; }
+
+        /*
+         * The doorbell of a channel only wakes the consumer if the ring
+         * holds data and no wakeup is pending already.
+         */
+        ALWAYS_INLINE
+        inline bool doorbell()
+        {
+            if (ACCESS_ONCE (chan_ring->head) == ACCESS_ONCE (chan_ring->tail))
+                return false;
+
+            Lock_guard <Spinlock> guard (lock);
+
+            return !counter;
         }
 
         ALWAYS_INLINE
@@ -20,62 +20,183 @@
 
 #pragma once
 
+#include "barrier.hpp"
 #include "bits.hpp"
 #include "lock_guard.hpp"
 #include "mdb.hpp"
+#include "x86.hpp"
 
+/*
+ * Writers serialize on the spinlock and bump the sequence count around
+ * every tree modification (odd while one is in progress). Readers walk
+ * the tree without the lock and retry if the count changed meanwhile.
+ * Removed nodes are freed via RCU, so a racing walk never touches freed
+ * memory.
+ *
+ * The nodes are additionally threaded in address order, so range walks
+ * step to the successor of the previous node instead of descending the
+ * tree again for every node.
+ */
 class Space
 {
     private:
-        Spinlock    lock { };
+        Spinlock    lock { Spinlock::LOCK_SPACE };
+        mword       seq { 0 };
         Avl *       tree;
+        Mdb *       tail { nullptr };
+
+        ALWAYS_INLINE
+        inline void write_begin() { ACCESS_ONCE (seq) = seq + 1; barrier(); }
+
+        ALWAYS_INLINE
+        inline void write_end() { barrier(); ACCESS_ONCE (seq) = seq + 1; }
+
+        void link (Mdb *node)
+        {
+            mword const end = node->node_base + (1UL << node->node_order);
+
+            Mdb *s = end ? Mdb::lookup (tree, end, true) : nullptr;
+            Mdb *p = s ? s->pred : tail;
+
+            node->succ = s;
+            node->pred = p;
+
+            if (p)
+                p->succ = node;
+
+            if (s)
+                s->pred = node;
+            else
+                tail = node;
+        }
+
+        void unlink (Mdb *node)
+        {
+            if (node->pred)
+                node->pred->succ = node->succ;
+
+            if (node->succ)
+                node->succ->pred = node->pred;
+            else
+                tail = node->pred;
+
+            node->pred = node;
+        }
 
     public:
         Space() : tree (nullptr) {}
 
         Mdb *tree_lookup (mword idx, bool next = false)
         {
-            Lock_guard <Spinlock> guard (lock);
-            return Mdb::lookup (tree, idx, next);
+            for (;; pause()) {
+
+                mword const s = ACCESS_ONCE (seq);
+                if (s & 1)
+                    continue;
+
+                barrier();
+
+                Mdb *m = Mdb::lookup (ACCESS_ONCE (tree), idx, next, true);
+
+                barrier();
+
+                if (ACCESS_ONCE (seq) == s)
+                    return m;
+            }
+        }
+
+        /*
+         * Next node of a range walk at or above addr. The hint is the
+         * successor of the previous node, read before that node was
+         * processed. It is used only if still in the tree and starting at
+         * addr, otherwise a node inserted in between would be skipped.
+         */
+        ALWAYS_INLINE
+        inline Mdb *tree_next (Mdb *hint, mword addr)
+        {
+            return hint && hint->node_base == addr && hint->linked() ? hint : tree_lookup (addr, true);
         }
 
         static bool tree_insert (Mdb *node)
         {
             Lock_guard <Spinlock> guard (node->space->lock);
-            return Mdb::insert<Mdb> (&node->space->tree, node);
+
+            node->space->write_begin();
+            bool const ok = Mdb::insert<Mdb> (&node->space->tree, node);
+            if (ok)
+                node->space->link (node);
+            node->space->write_end();
+
+            return ok;
+        }
+
+        /* old must have left the mapping database, so nobody else removes it */
+        static void tree_replace (Mdb *old, Mdb *node)
+        {
+            Lock_guard <Spinlock> guard (node->space->lock);
+
+            node->space->write_begin();
+            if (Mdb::remove<Mdb> (&node->space->tree, old)) {
+                node->space->unlink (old);
+                if (Mdb::insert<Mdb> (&node->space->tree, node))
+                    node->space->link (node);
+            }
+            node->space->write_end();
         }
 
         static bool tree_remove (Mdb *node)
         {
             Lock_guard <Spinlock> guard (node->space->lock);
-            return Mdb::remove<Mdb> (&node->space->tree, node);
+
+            node->space->write_begin();
+            bool const ok = Mdb::remove<Mdb> (&node->space->tree, node);
+            if (ok)
+                node->space->unlink (node);
+            node->space->write_end();
+
+            return ok;
         }
 
         void addreg (Quota &quota, Slab_cache &cache, mword addr, size_t size, mword attr, mword type = 0)
         {
             Lock_guard <Spinlock> guard (lock);
 
-            for (mword o; size; size -= 1UL << o, addr += 1UL << o)
-                Mdb::insert<Mdb> (&tree, new (quota, cache) Mdb (nullptr, nullptr, addr, addr, (o = max_order (addr, size)), attr, type));
+            for (mword o; size; size -= 1UL << o, addr += 1UL << o) {
+                Mdb *node = new (quota, cache) Mdb (nullptr, nullptr, addr, addr, (o = max_order (addr, size)), attr, type);
+
+                write_begin();
+                if (Mdb::insert<Mdb> (&tree, node))
+                    link (node);
+                write_end();
+            }
         }
 
-        void delreg (Quota &quota, Slab_cache &cache, mword addr)
+        /* boot-time only, removed nodes are freed without a grace period */
+        void delreg (Quota &quota, Slab_cache &cache, mword addr, size_t size = PAGE_SIZE)
         {
-            Mdb *node;
+            mword const s = addr >> PAGE_BITS, e = s + (size >> PAGE_BITS);
 
-            {   Lock_guard <Spinlock> guard (lock);
+            for (Mdb *node;;) {
 
-                if (!(node = Mdb::lookup (tree, addr >>= PAGE_BITS, false)))
-                    return;
+                {   Lock_guard <Spinlock> guard (lock);
 
-                Mdb::remove<Mdb> (&tree, node);
-            }
+                    if (!(node = Mdb::lookup (tree, s, true)) || node->node_base >= e)
+                        return;
 
-            mword next = addr + 1, base = node->node_base, last = base + (1UL << node->node_order);
+                    write_begin();
+                    Mdb::remove<Mdb> (&tree, node);
+                    unlink (node);
+                    write_end();
+                }
 
-            addreg (quota, cache, base, addr - base, node->node_attr, node->node_type);
-            addreg (quota, cache, next, last - next, node->node_attr, node->node_type);
+                mword base = node->node_base, last = base + (1UL << node->node_order);
 
-            Mdb::destroy (node, quota, cache);
+                if (base < s)
+                    addreg (quota, cache, base, s - base, node->node_attr, node->node_type);
+                if (last > e)
+                    addreg (quota, cache, e, last - e, node->node_attr, node->node_type);
+
+                Mdb::destroy (node, quota, cache);
+            }
         }
 };
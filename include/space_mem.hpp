@@ -48,6 +48,9 @@ class Space_mem : public Space
         };
 
         enum { NO_PCID = 2, NO_DOMAIN_ID = 0, NO_ASID_ID = 0 };
+
+        /* subspace flag of copy-on-write mappings, mapped read-only until written */
+        enum { SUB_COW = 0x8 };
         mword did { NO_PCID };
         mword asid { NO_ASID_ID };
 
@@ -108,5 +111,5 @@ class Space_mem : public Space
         void init (Quota &quota, unsigned);
 
         ALWAYS_INLINE
-        inline mword sticky_sub(mword s) { return s & 0x4; }
+        inline mword sticky_sub(mword s) { return s & (0x4 | SUB_COW); }
 };
@@ -21,20 +21,129 @@
 #include "compiler.hpp"
 #include "types.hpp"
 
+#ifdef LOCK_STATS
+#include "memory.hpp"
+#include "x86.hpp"
+#endif
+
 class Spinlock
 {
+    public:
+        enum Class
+        {
+            LOCK_OTHER,
+            LOCK_KOBJ,
+            LOCK_MDB,
+            LOCK_MDB_NODE,
+            LOCK_SPACE,
+            LOCK_COW,
+            LOCK_BUDDY,
+            LOCK_SLAB,
+            LOCK_QUOTA,
+            LOCK_RQ,
+            LOCK_SI,
+            LOCK_CONSOLE,
+            LOCK_IOMMU,
+            LOCK_IOAPIC,
+            NUM_CLASSES
+        };
+
+        /*
+         * Per-CPU statistics of one lock class, exported in the second
+         * statistics page. Only kernels built with LOCK_STATS fill them.
+         */
+        struct Stat
+        {
+            uint64  acquired;
+            uint64  contended;
+            uint64  spin;
+            uint64  hold_max;
+        };
+
+        static Stat stats[NUM_CLASSES] CPULOCAL_LOCK;
+
     private:
         uint16 val;
 
+#ifdef LOCK_STATS
+        uint8  cls;
+        uint32 held;
+
+        /*
+         * The statistics pages are only mapped once the CPU runs on its
+         * own kernel stack, which excludes early boot and resume.
+         */
+        ALWAYS_INLINE
+        static inline bool mapped()
+        {
+            mword sp;
+            return reinterpret_cast<mword>(&sp) - CPU_LOCAL_STCK <= PAGE_SIZE;
+        }
+
+        ALWAYS_INLINE
+        inline void acquired (uint64 t, bool c)
+        {
+            uint64 const now = rdtsc();
+
+            held = static_cast<uint32>(now);
+
+            if (EXPECT_FALSE (!mapped()))
+                return;
+
+            Stat &s = stats[cls];
+
+            s.acquired++;
+
+            if (c) {
+                s.contended++;
+                s.spin += now - t;
+            }
+        }
+
+        ALWAYS_INLINE
+        inline void released()
+        {
+            uint32 const h = static_cast<uint32>(rdtsc()) - held;
+
+            if (EXPECT_FALSE (!mapped()))
+                return;
+
+            if (h > stats[cls].hold_max)
+                stats[cls].hold_max = h;
+        }
+#endif
+
     public:
+#ifdef LOCK_STATS
+        ALWAYS_INLINE
+        inline explicit Spinlock (Class c = LOCK_OTHER) : val (0), cls (static_cast<uint8>(c)), held (0) {}
+#else
         ALWAYS_INLINE
-        inline Spinlock() : val (0) {}
+        inline explicit Spinlock (Class = LOCK_OTHER) : val (0) {}
+#endif
 
         NOINLINE
         void lock()
         {
             uint16 tmp = 0x100;
 
+#ifdef LOCK_STATS
+            uint64 const t = rdtsc();
+            bool c = false;
+
+            asm volatile ("     lock; xadd %0, %1;  "
+                          "     cmpb %h0, %b0;      "
+                          "     je 2f;              "
+                          "     movb $1, %2;        "
+                          "1:   pause;              "
+                          "     movb %1, %b0;       "
+                          "     cmpb %h0, %b0;      "
+                          "     jne 1b;             "
+                          "2:                       "
+                          : "+Q" (tmp), "+m" (val), "+m" (c) : : "memory");
+
+            acquired (t, c);
+#else
             asm volatile ("     lock; xadd %0, %1;  "
                           "1:   cmpb %h0, %b0;      "
                           "     je 2f;              "
@@ -43,11 +152,15 @@ class Spinlock
                           "     jmp 1b;             "
                           "2:                       "
                           : "+Q" (tmp), "+m" (val) : : "memory");
+#endif
         }
 
         ALWAYS_INLINE
         inline void unlock()
         {
+#ifdef LOCK_STATS
+            released();
+#endif
             asm volatile ("incb %0" : "+m" (val) : : "memory");
         }
 };
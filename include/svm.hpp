@@ -123,7 +123,7 @@ union {
         ALWAYS_INLINE
         static inline void *operator new (size_t, Quota &quota)
         {
-            return Buddy::allocator.alloc (0, quota, Buddy::FILL_0);
+            return Buddy::allocator.alloc (0, quota, Buddy::FILL_0, Quota::KIND_VCPU);
         }
 
         static void destroy(Vmcb &, Quota &);
@@ -31,7 +31,8 @@ class Sys_call : public Sys_regs
         {
             DISABLE_BLOCKING    = 1ul << 0,
             DISABLE_DONATION    = 1ul << 1,
-            DISABLE_REPLYCAP    = 1ul << 2
+            DISABLE_REPLYCAP    = 1ul << 2,
+            REGISTER_MSG        = 1ul << 3
         };
 
         ALWAYS_INLINE
@@ -117,6 +118,14 @@ class Sys_create_pt : public Sys_regs
 class Sys_create_sm : public Sys_regs
 {
     public:
+        enum { CHANNEL = 1 };
+
+        ALWAYS_INLINE
+        inline bool chan() const { return flags() & CHANNEL; }
+
+        ALWAYS_INLINE
+        inline mword chan_addr() const { return ARG_3; }
+
         ALWAYS_INLINE
         inline unsigned long sel() const { return ARG_1 >> 8; }
 
@@ -157,7 +166,7 @@ class Sys_revoke : public Sys_regs
 class Sys_misc : public Sys_regs
 {
     public:
-        enum { SYS_LOOKUP = 0, SYS_DELEGATE = 1, SYS_ACPI_SUSPEND };
+        enum { SYS_LOOKUP = 0, SYS_DELEGATE = 1, SYS_ACPI_SUSPEND, SYS_CALL_VEC, SYS_CALL_ASYNC };
 
         ALWAYS_INLINE
         inline Crd & crd() { return reinterpret_cast<Crd &>(ARG_2); }
@@ -173,11 +182,31 @@ class Sys_misc : public Sys_regs
 
         ALWAYS_INLINE
         inline mword sleep_type_b() const { return ARG_3; }
+
+        ALWAYS_INLINE
+        inline mword vec_cnt() const { return ARG_2; }
+
+        ALWAYS_INLINE
+        inline mword & vec_done() { return ARG_3; }
+
+        ALWAYS_INLINE
+        inline unsigned long async_ec() const { return ARG_1 >> 8; }
+
+        ALWAYS_INLINE
+        inline unsigned long async_pt() const { return ARG_2; }
+
+        ALWAYS_INLINE
+        inline unsigned long async_sm() const { return ARG_3; }
 };
 
 class Sys_reply : public Sys_regs
 {
     public:
+        enum
+        {
+            REGISTER_MSG        = 1ul << 3
+        };
+
         ALWAYS_INLINE
         inline unsigned long sm() const { return ARG_1 >> 8; }
 
@@ -212,6 +241,25 @@ class Sys_ec_ctrl : public Sys_regs
         ALWAYS_INLINE
         inline Crd crd() const { return Crd (ARG_3); }
 
+        ALWAYS_INLINE
+        inline mword pmu_event() const { return ARG_2; }
+
+        ALWAYS_INLINE
+        inline mword pmu_period() const { return ARG_3; }
+
+        ALWAYS_INLINE
+        inline mword pmu_depth() const { return ARG_4; }
+
+        ALWAYS_INLINE
+        inline mword exit_reason() const { return ARG_2; }
+
+        ALWAYS_INLINE
+        inline void set_drained (mword n, mword lost)
+        {
+            ARG_2 = n;
+            ARG_3 = lost;
+        }
+
         inline void set_time (uint64 val)
         {
             ARG_2 = static_cast<mword>(val >> 32);
@@ -231,6 +279,9 @@ class Sys_sc_ctrl : public Sys_regs
         ALWAYS_INLINE
         inline unsigned op() const { return flags() & 0x3; }
 
+        ALWAYS_INLINE
+        inline bool stat() const { return flags() & 0x4; }
+
         ALWAYS_INLINE
         inline void set_time (uint64 val)
         {
@@ -280,9 +331,39 @@ class Sys_pd_ctrl : public Sys_regs
         ALWAYS_INLINE
         inline unsigned long src() const { return ARG_1 >> 8; }
 
+        ALWAYS_INLINE
+        inline unsigned kmem() const { return flags() & 0x1; }
+
         ALWAYS_INLINE
         inline unsigned dbg() const { return flags() & 0x2; }
 
+        ALWAYS_INLINE
+        inline unsigned merge() const { return flags() & 0x4; }
+
+        ALWAYS_INLINE
+        inline mword src_page() const { return ARG_3; }
+
+        ALWAYS_INLINE
+        inline mword dst_page() const { return ARG_4; }
+
+        ALWAYS_INLINE
+        inline void merged (bool m) { ARG_2 = m; }
+
+        ALWAYS_INLINE
+        inline unsigned harvest() const { return flags() & 0x8; }
+
+        ALWAYS_INLINE
+        inline mword harvest_addr() const { return ARG_3 & ~PAGE_MASK; }
+
+        ALWAYS_INLINE
+        inline bool harvest_guest() const { return ARG_3 & 1; }
+
+        ALWAYS_INLINE
+        inline mword harvest_pages() const { return ARG_2; }
+
+        ALWAYS_INLINE
+        inline void harvested (mword n) { ARG_2 = n; }
+
         ALWAYS_INLINE
         inline unsigned long dst() const { return ARG_2; }
 
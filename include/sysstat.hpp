@@ -0,0 +1,67 @@
+/*
+ * System-Call Statistics
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "histogram.hpp"
+#include "x86.hpp"
+
+/*
+ * Per-CPU count and cycles of each system call, measured from kernel
+ * entry until the CPU next leaves the kernel or goes idle. Exported after
+ * the lock statistics in the second statistics page. Only kernels built
+ * with SYSCALL_STATS fill them.
+ */
+class Sysstat
+{
+    public:
+        static unsigned const SYSCALLS = 16;
+
+        struct Stat
+        {
+            uint64              count;
+            uint64              cycles;
+            Histogram<16, 8>    hist;
+        };
+
+        static Stat stats[SYSCALLS] CPULOCAL_SYS;
+
+    private:
+        static uint64   start   CPULOCAL;
+        static mword    number  CPULOCAL;
+
+    public:
+        REGPARM (1)
+        static void entered (mword) asm ("syscall_stat");
+
+        ALWAYS_INLINE
+        static inline void left()
+        {
+#ifdef SYSCALL_STATS
+            if (!start)
+                return;
+
+            uint64 const c = rdtsc() - start;
+
+            Stat &s = stats[number];
+
+            s.count++;
+            s.cycles += c;
+            s.hist.add (c);
+
+            start = 0;
+#endif
+        }
+};
@@ -0,0 +1,96 @@
+/*
+ * Trace Buffer
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "barrier.hpp"
+#include "cpu.hpp"
+#include "x86.hpp"
+
+/*
+ * Per-CPU ring of TSC-stamped binary event records. The first record
+ * of each ring is the header, which holds the number of records ever
+ * written and the slot of the next one. Old records are overwritten,
+ * a reader detects this by comparing the head before and after reading.
+ */
+class Tracebuf
+{
+    public:
+        enum Event
+        {
+            EVT_SWITCH      = 1,    // a: next Ec, b: previous Ec
+            EVT_CALL        = 2,    // a: callee Ec, b: portal id
+            EVT_REPLY       = 3,    // a: caller Ec
+            EVT_VMEXIT      = 4,    // a: Ec, b: exit reason
+            EVT_IRQ         = 5,    // a: GSI
+            EVT_SHOOTDOWN   = 6,    // a: Pd, b: CPUs signalled
+            EVT_RCU         = 7,    // a: batch
+        };
+
+        struct Record
+        {
+            uint64  tsc;
+            uint64  event;
+            uint64  a;
+            uint64  b;
+        };
+
+        struct Header
+        {
+            uint64  head;
+            uint32  records;
+            uint32  size;
+            uint64  next;
+            uint64  reserved;
+        };
+
+        static_assert (sizeof (Header) == sizeof (Record), "Unsupported size of trace header");
+
+        static unsigned const ORD = 4;
+        static unsigned const RECORDS = (PAGE_SIZE << ORD) / sizeof (Record) - 1;
+
+        static Paddr    phys;
+        static size_t   size;
+
+        static void init();
+
+        ALWAYS_INLINE
+        static inline void log (Event e, mword a = 0, mword b = 0)
+        {
+            Header *h = ACCESS_ONCE (base);
+
+            if (EXPECT_TRUE (!h))
+                return;
+
+            h = reinterpret_cast<Header *>(reinterpret_cast<mword>(h) + Cpu::id * (PAGE_SIZE << ORD));
+
+            mword const n = static_cast<mword>(h->next);
+
+            Record *r = reinterpret_cast<Record *>(h + 1) + n;
+
+            r->tsc   = rdtsc();
+            r->event = e;
+            r->a     = a;
+            r->b     = b;
+
+            barrier();
+
+            h->next = n + 1 < RECORDS ? n + 1 : 0;
+            h->head++;
+        }
+
+    private:
+        static Header *base;
+};
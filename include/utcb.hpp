@@ -44,6 +44,33 @@ class Utcb_segment
         }
 };
 
+/*
+ * Descriptor of one call of a vectored portal call, stored in the
+ * caller's message words: message length, offset of the message region
+ * and portal selector. The regions follow the descriptor table.
+ */
+class Vec_call
+{
+    private:
+        mword val;
+
+    public:
+        ALWAYS_INLINE
+        inline explicit Vec_call (mword v) : val (v) {}
+
+        ALWAYS_INLINE
+        inline mword cnt() const { return val & 0xff; }
+
+        ALWAYS_INLINE
+        inline mword ofs() const { return val >> 8 & 0xff; }
+
+        ALWAYS_INLINE
+        inline mword pt() const { return val >> 16; }
+
+        ALWAYS_INLINE
+        inline mword with_cnt (mword n) const { return (val & ~0xfful) | n; }
+};
+
 class Utcb_head
 {
     protected:
@@ -111,6 +138,8 @@ class Utcb : public Utcb_head, private Utcb_data
         WARN_UNUSED_RESULT bool save_vmx (Cpu_regs *);
         WARN_UNUSED_RESULT bool save_svm (Cpu_regs *);
 
+        inline void clear_items() { items = 0; }
+
         inline mword ucnt() const { return static_cast<uint16>(items); }
         inline mword tcnt() const { return static_cast<uint16>(items >> 16); }
 
@@ -132,14 +161,88 @@ class Utcb : public Utcb_head, private Utcb_data
 #endif
         }
 
+        ALWAYS_INLINE
+        inline Vec_call vec (mword i) const { return Vec_call (ACCESS_ONCE (mr[i])); }
+
+        /* regions lie behind the table of c descriptors, so that replies cannot rewrite it */
+        ALWAYS_INLINE
+        static inline bool fits (Vec_call v, mword c) { return v.ofs() >= c && v.ofs() + v.cnt() <= words; }
+
+        ALWAYS_INLINE
+        inline bool vec_valid (mword i, mword c) const { return i < c && i < words && fits (vec (i), c); }
+
+        /*
+         * Copy the request region of call i of c of this UTCB to dst. The
+         * descriptor is read once and checked again, because user space
+         * can change it after vec_valid.
+         */
+        ALWAYS_INLINE NONNULL
+        inline void load_vec (Utcb *dst, mword i, mword c)
+        {
+            Vec_call const v = vec (i);
+            mword    const n = fits (v, c) ? v.cnt() : 0;
+
+            dst->items = n;
+
+            for (unsigned long j = 0; j < n; j++)
+                dst->mr[j] = mr[v.ofs() + j];
+        }
+
+        /*
+         * Copy the reply to the region of call i of dst, truncated to
+         * the region size. The descriptor receives the reply length.
+         */
+        ALWAYS_INLINE NONNULL
+        inline void save_vec (Utcb *dst, mword i, mword c)
+        {
+            Vec_call const v = dst->vec (i);
+            mword    const n = fits (v, c) ? min (ui(), v.cnt()) : 0;
+
+            for (unsigned long j = 0; j < n; j++)
+                dst->mr[v.ofs() + j] = mr[j];
+
+            dst->mr[i] = v.with_cnt (n);
+        }
+
+        /*
+         * Message words used as a bitmap, e.g. for accessed-bit reports.
+         */
+        ALWAYS_INLINE
+        static inline mword bitmap_size() { return words * sizeof (mword) * 8; }
+
+        ALWAYS_INLINE
+        inline void bitmap (mword i, bool v)
+        {
+            mword const b = sizeof (mword) * 8, m = 1UL << (i % b);
+
+            mr[i / b] = v ? mr[i / b] | m : mr[i / b] & ~m;
+        }
+
+        /*
+         * Store n raw words at message word i, if they fit.
+         */
+        ALWAYS_INLINE
+        inline bool store (mword i, void const *src, mword n)
+        {
+            if (i + n > words)
+                return false;
+
+            for (mword j = 0; j < n; j++)
+                mr[i + j] = static_cast<mword const *>(src)[j];
+
+            items = i + n;
+
+            return true;
+        }
+
         ALWAYS_INLINE
         inline Xfer *xfer() { return reinterpret_cast<Xfer *>(this) + PAGE_SIZE / sizeof (Xfer) - 1; }
 
         ALWAYS_INLINE
-        static inline void *operator new (size_t, Quota &quota) { return Buddy::allocator.alloc (0, quota, Buddy::FILL_0); }
+        static inline void *operator new (size_t, Quota &quota) { return Buddy::allocator.alloc (0, quota, Buddy::FILL_0, Quota::KIND_UTCB); }
 
         ALWAYS_INLINE
-        static inline void destroy(Utcb *obj, Quota &quota) { obj->~Utcb(); Buddy::allocator.free (reinterpret_cast<mword>(obj), quota); }
+        static inline void destroy(Utcb *obj, Quota &quota) { obj->~Utcb(); Buddy::allocator.free (reinterpret_cast<mword>(obj), quota, Quota::KIND_UTCB); }
 
         template <typename F>
         void fpu_mr(F const &fn) { fn(&fpu); }
@@ -0,0 +1,102 @@
+/*
+ * VM Exit Statistics
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "buddy.hpp"
+#include "config.hpp"
+#include "histogram.hpp"
+#include "string.hpp"
+#include "x86.hpp"
+
+/*
+ * Per-vCPU histograms of the cycles from a VM exit to the next VM entry,
+ * by exit reason. The kernel histogram counts every exit, the VMM
+ * histogram only those that were delivered to the VMM.
+ */
+class Vmstat
+{
+    public:
+        static unsigned const ORD = 3;
+
+        struct Hist
+        {
+            Histogram<15, 8>    kern;
+            Histogram<15, 8>    vmm;
+        };
+
+    private:
+        Hist    hist[NUM_VMI];
+        uint64  exit;       // TSC at VM exit, 0 without pending exit
+        uint64  sent;       // TSC at delivery to the VMM, 0 in the kernel
+        uint64  vmm;        // cycles spent in the VMM
+        mword   reason;
+
+    public:
+        ALWAYS_INLINE
+        inline Hist const &histogram (mword r) const { return hist[r]; }
+
+        ALWAYS_INLINE
+        inline void reset() { memset (hist, 0, sizeof (hist)); }
+
+        ALWAYS_INLINE
+        inline void exited (mword r)
+        {
+            exit   = rdtsc();
+            sent   = vmm = 0;
+            reason = r;
+        }
+
+        ALWAYS_INLINE
+        inline void delivered()
+        {
+            if (exit)
+                sent = rdtsc();
+        }
+
+        ALWAYS_INLINE
+        inline void resumed()
+        {
+            if (!sent)
+                return;
+
+            vmm += rdtsc() - sent;
+            sent = 0;
+        }
+
+        ALWAYS_INLINE
+        inline void entered()
+        {
+            if (!exit)
+                return;
+
+            Hist &h = hist[reason];
+
+            h.kern.add (rdtsc() - exit - vmm);
+
+            if (vmm)
+                h.vmm.add (vmm);
+
+            exit = 0;
+        }
+
+        ALWAYS_INLINE
+        static inline void *operator new (size_t, Quota &quota) { return Buddy::allocator.alloc (ORD, quota, Buddy::FILL_0, Quota::KIND_VCPU); }
+
+        ALWAYS_INLINE
+        static inline void destroy (Vmstat *obj, Quota &quota) { Buddy::allocator.free (reinterpret_cast<mword>(obj), quota, Quota::KIND_VCPU); }
+};
+
+static_assert (sizeof (Vmstat) <= PAGE_SIZE << Vmstat::ORD, "Unsupported size of VM exit statistics");
@@ -368,14 +368,14 @@ class Vmcs
         ALWAYS_INLINE
         static inline void *operator new (size_t, Quota &quota)
         {
-            return Buddy::allocator.alloc (0, quota, Buddy::FILL_0);
+            return Buddy::allocator.alloc (0, quota, Buddy::FILL_0, Quota::KIND_VCPU);
         }
 
         ALWAYS_INLINE
         static inline void destroy(Vmcs *obj, Quota &quota)
         {
             obj->~Vmcs();
-            Buddy::allocator.free (reinterpret_cast<mword>(obj), quota);
+            Buddy::allocator.free (reinterpret_cast<mword>(obj), quota, Quota::KIND_VCPU);
         }
 
         Vmcs (Quota &, mword, mword, mword, uint64);
@@ -496,13 +496,13 @@ struct Msr_area
     static inline void *operator new (size_t, Quota &quota)
     {
         /* allocate one page */
-        return Buddy::allocator.alloc (0, quota, Buddy::FILL_0);
+        return Buddy::allocator.alloc (0, quota, Buddy::FILL_0, Quota::KIND_VCPU);
     }
 
     ALWAYS_INLINE
     static inline void destroy(Msr_area *obj, Quota &quota)
     {
-        Buddy::allocator.free (reinterpret_cast<mword>(obj), quota);
+        Buddy::allocator.free (reinterpret_cast<mword>(obj), quota, Quota::KIND_VCPU);
     }
 };
 
@@ -514,13 +514,13 @@ struct Msr_bitmap
     static inline void *operator new (size_t, Quota &quota)
     {
         /* allocate one page and set all bits */
-        return Buddy::allocator.alloc(0, quota, Buddy::FILL_1);
+        return Buddy::allocator.alloc(0, quota, Buddy::FILL_1, Quota::KIND_VCPU);
     }
 
     ALWAYS_INLINE
     static inline void destroy(Msr_bitmap *obj, Quota &quota)
     {
-        Buddy::allocator.free(reinterpret_cast<mword>(obj), quota);
+        Buddy::allocator.free(reinterpret_cast<mword>(obj), quota, Quota::KIND_VCPU);
     }
 
     void disable_msr_exit(Msr::Register const & reg)
@@ -554,13 +554,13 @@ struct Virtual_apic_page
     static inline void *operator new (size_t, Quota &quota)
     {
         /* allocate one page */
-        return Buddy::allocator.alloc (0, quota, Buddy::FILL_0);
+        return Buddy::allocator.alloc (0, quota, Buddy::FILL_0, Quota::KIND_VCPU);
     }
 
     ALWAYS_INLINE
     static inline void destroy(Virtual_apic_page *obj, Quota &quota)
     {
-        Buddy::allocator.free (reinterpret_cast<mword>(obj), quota);
+        Buddy::allocator.free (reinterpret_cast<mword>(obj), quota, Quota::KIND_VCPU);
     }
 
     uint32 vtpr() { return data[VTPR]; }
@@ -92,8 +92,8 @@ class Vtlb : public Pte<Vtlb, uint64, 3,  9, false, false>
         static Reason miss (Cpu_regs *, mword, mword &);
 
         ALWAYS_INLINE
-        static inline void *operator new (size_t, Quota &quota) { return Buddy::allocator.alloc (0, quota, Buddy::NOFILL); }
+        static inline void *operator new (size_t, Quota &quota) { return Buddy::allocator.alloc (0, quota, Buddy::NOFILL, Quota::KIND_VTLB); }
 
         ALWAYS_INLINE
-        static inline void destroy(Vtlb *obj, Quota &quota) { obj->~Vtlb(); Buddy::allocator.free (reinterpret_cast<mword>(obj), quota); }
+        static inline void destroy(Vtlb *obj, Quota &quota) { obj->~Vtlb(); Buddy::allocator.free (reinterpret_cast<mword>(obj), quota, Quota::KIND_VTLB); }
 };
@@ -75,8 +75,26 @@ Buddy::Buddy (mword phys, mword virt, mword f_addr, size_t size)
     for (unsigned i = 0; i < order; i++)
         head[i].next = head[i].prev = head + i;
 
-    for (mword i = f_addr; i < virt + size; i += PAGE_SIZE)
+    /*
+     * Free the pool in maximal aligned blocks. Merging only ever inspects
+     * block heads, so these are initialized up front and the remaining
+     * metadata and the memory itself need not be touched (allocations
+     * zero on demand).
+     */
+    mword const end = virt + size;
+
+    for (mword i = f_addr, o; i < end; i += PAGE_SIZE << o) {
+        o = min (max_order (static_cast<mword>(page_to_index (i)), (end - i) / PAGE_SIZE), order - 1);
+
+        Block *block = index_to_block (page_to_index (i));
+        block->ord = static_cast<unsigned short>(o);
+        block->tag = Block::Used;
+    }
+
+    for (mword i = f_addr, n; i < end; i += n) {
+        n = PAGE_SIZE << index_to_block (page_to_index (i))->ord;
         _free (i, Quota::init);
+    }
 }
 
 /*
@@ -85,7 +103,7 @@ Buddy::Buddy (mword phys, mword virt, mword f_addr, size_t size)
  * @param zero      Zero out block content if true
  * @return          Pointer to linear memory region
  */
-void *Buddy::_alloc (unsigned short ord, Quota &quota, Fill fill)
+void *Buddy::_alloc (unsigned short ord, Quota &quota, Fill fill, Quota::Kind kind)
 {
     Lock_guard <Spinlock> guard (lock);
 
@@ -116,7 +134,7 @@ void *Buddy::_alloc (unsigned short ord, Quota &quota, Fill fill)
         if (fill)
             memset (reinterpret_cast<void *>(virt), fill == FILL_0 ? 0 : -1, 1ul << (block->ord + PAGE_BITS));
 
-        quota.alloc(1ul << ord);
+        quota.alloc(1ul << ord, kind);
 
         return reinterpret_cast<void *>(virt);
     }
@@ -124,10 +142,10 @@ void *Buddy::_alloc (unsigned short ord, Quota &quota, Fill fill)
     return nullptr;
 }
 
-void *Buddy::alloc (unsigned short ord, Quota &quota, Fill fill)
+void *Buddy::alloc (unsigned short ord, Quota &quota, Fill fill, Quota::Kind kind)
 {
     for (Buddy *b = list; b; b = b->next) {
-        void * v = b->_alloc(ord, quota, fill);
+        void * v = b->_alloc(ord, quota, fill, kind);
         if (v) return v;
     }
 
@@ -140,7 +158,7 @@ void *Buddy::alloc (unsigned short ord, Quota &quota, Fill fill)
  * Free physically contiguous memory region.
  * @param virt     Linear block base address
  */
-void Buddy::_free (mword virt, Quota &quota)
+void Buddy::_free (mword virt, Quota &quota, Quota::Kind kind)
 {
     signed long idx = page_to_index (virt);
 
@@ -155,7 +173,7 @@ void Buddy::_free (mword virt, Quota &quota)
     // Ensure corresponding physical block is order-aligned
     assert ((virt_to_phys (virt) & ((1ul << (block->ord + PAGE_BITS)) - 1)) == 0);
 
-    quota.free(1ul << block->ord);
+    quota.free(1ul << block->ord, kind);
 
     Lock_guard <Spinlock> guard (lock);
 
@@ -195,12 +213,12 @@ void Buddy::_free (mword virt, Quota &quota)
     block->next->prev = h->next = block;
 }
 
-void Buddy::free (mword virt, Quota &quota)
+void Buddy::free (mword virt, Quota &quota, Quota::Kind kind)
 {
     for (Buddy *b = list; b; b = b->next) {
         signed long idx = b->page_to_index (virt);
         if (idx >= b->min_idx && idx < b->max_idx) {
-            b->_free(virt, quota);
+            b->_free(virt, quota, kind);
             return;
         }
     }
@@ -37,6 +37,7 @@ bool Cmdline::novpid;
 bool Cmdline::logmem;
 bool Cmdline::fpu_lazy;
 bool Cmdline::hlt;
+bool Cmdline::tracebuf;
 
 struct Cmdline::param_map Cmdline::map[] INITDATA =
 {
@@ -53,6 +54,7 @@ struct Cmdline::param_map Cmdline::map[] INITDATA =
     { "logmem",      &Cmdline::logmem      },
     { "fpu_lazy",    &Cmdline::fpu_lazy    },
     { "hlt",         &Cmdline::hlt         },
+    { "tracebuf",    &Cmdline::tracebuf    },
 };
 
 char const *Cmdline::get_arg (char const **line, unsigned &len)
@@ -18,13 +18,94 @@
  * GNU General Public License version 2 for more details.
  */
 
+#include "atomic.hpp"
+#include "barrier.hpp"
 #include "bits.hpp"
 #include "console.hpp"
+#include "cpu.hpp"
+#include "hazards.hpp"
 #include "lock_guard.hpp"
+#include "memory.hpp"
 #include "x86.hpp"
 
+/*
+ * Ring of the messages printed on one CPU, which the consoles are fed
+ * from later. Only the owning CPU adds to it and only the holder of the
+ * console lock takes from it, so the two sides need no lock between them.
+ */
+class Console::Buffer : public Console
+{
+    private:
+        static unsigned const RING = PAGE_SIZE;
+
+        char    data[RING];
+        mword   head { 0 };     // end of the published messages
+        mword   tail { 0 };     // end of the messages written out
+        mword   next { 0 };     // end of the message being formatted
+
+        void reenable() override { }
+
+    public:
+        static unsigned const LINE = 80;
+
+        /* a full ring is written out synchronously, nothing is dropped */
+        void putc (int c) override
+        {
+            if (EXPECT_FALSE (next - ACCESS_ONCE (tail) == RING)) {
+                publish();
+
+                Lock_guard <Spinlock> guard (lock);
+                write();
+            }
+
+            data[next++ % RING] = static_cast<char>(c);
+        }
+
+        ALWAYS_INLINE
+        inline void publish()
+        {
+            barrier();
+            ACCESS_ONCE (head) = next;
+        }
+
+        ALWAYS_INLINE
+        inline bool pending() const { return ACCESS_ONCE (head) != ACCESS_ONCE (tail); }
+
+        /* requires the console lock, writes at most n characters */
+        mword write (mword n = ~0UL)
+        {
+            mword w = 0;
+
+            for (mword h = ACCESS_ONCE (head); tail != h && w < n; w++) {
+
+                for (Console *c = list; c; c = c->next)
+                    c->putc (data[tail % RING]);
+
+                ACCESS_ONCE (tail) = tail + 1;
+            }
+
+            return w;
+        }
+};
+
 Console *Console::list, *Console::disabled;
-Spinlock Console::lock;
+Spinlock Console::lock { Spinlock::LOCK_CONSOLE };
+
+INIT_PRIORITY (PRIO_CONSOLE)
+Console::Buffer Console::ring[NUM_CPU];
+
+static mword draining;
+static unsigned first;      // ring the next flush pass starts with
+
+/*
+ * Before a CPU runs on its own stack (early boot, resume) Cpu::id is not
+ * known and messages are written out synchronously.
+ */
+static inline bool buffered()
+{
+    mword sp;
+    return ((reinterpret_cast<mword>(&sp) - 1) & ~PAGE_MASK) == CPU_LOCAL_STCK;
+}
 
 void Console::print_num (uint64 val, unsigned base, unsigned width, unsigned flags)
 {
@@ -174,10 +255,88 @@ void Console::vprintf (char const *format, va_list args)
     putc ('\n');
 }
 
+/* requires the console lock */
+void Console::drain()
+{
+    for (unsigned c = 0; c < NUM_CPU; c++)
+        ring[c].write();
+}
+
+/*
+ * Called by idle CPUs. The rings are written out a line at a time, with
+ * the lock dropped and interrupts let in between, until they are empty
+ * or a hazard calls the CPU away. The return value tells the caller to
+ * look at its hazards again, also when one was raised by an interrupt
+ * let in after the last line. A CPU
+ * that finds another one draining goes back to sleep rather than spin
+ * for the console lock.
+ */
+bool Console::flush()
+{
+    bool p = false;
+
+    for (unsigned c = 0; c < NUM_CPU && !p; c++)
+        p = ring[c].pending();
+
+    if (!p || Atomic::test_set_bit (draining, 0))
+        return false;
+
+    /* the hazards Ec::idle acts on */
+    unsigned const hzd = HZD_RCU | HZD_SCHED | HZD_TSC_AUX;
+
+    bool more = true;
+
+    for (; more && !(Cpu::hazard & hzd); Cpu::preemption_point()) {
+
+        Lock_guard <Spinlock> guard (lock);
+
+        mword n = 0;
+
+        for (unsigned i = 0; i < NUM_CPU && n < Buffer::LINE; i++)
+            n += ring[(first + i) % NUM_CPU].write (Buffer::LINE - n);
+
+        first = (first + 1) % NUM_CPU;
+
+        /* a full line may have left more behind */
+        more = n == Buffer::LINE;
+    }
+
+    Atomic::test_clr_bit (draining, 0);
+
+    return more || (Cpu::hazard & hzd);
+}
+
+/*
+ * Everything buffered is written out before the consoles go away.
+ */
+void Console::disable_all()
+{
+    {   Lock_guard <Spinlock> guard (lock);
+        drain();
+    }
+
+    disabled = list;
+    list = nullptr;
+}
+
 void Console::print (char const *format, ...)
 {
+    if (EXPECT_TRUE (buffered())) {
+        Buffer &b = ring[Cpu::id];
+
+        va_list args;
+        va_start (args, format);
+        b.vprintf (format, args);
+        va_end (args);
+
+        b.publish();
+        return;
+    }
+
     Lock_guard <Spinlock> guard (lock);
 
+    drain();
+
     for (Console *c = list; c; c = c->next) {
         va_list args;
         va_start (args, format);
@@ -190,6 +349,8 @@ void Console::panic (char const *format, ...)
 {
     {   Lock_guard <Spinlock> guard (lock);
 
+        drain();
+
         for (Console *c = list; c; c = c->next) {
             va_list args;
             va_start (args, format);
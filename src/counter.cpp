@@ -18,63 +18,70 @@
  * GNU General Public License version 2 for more details.
  */
 
+#include "bits.hpp"
 #include "counter.hpp"
+#include "pd.hpp"
 #include "stdio.hpp"
 #include "x86.hpp"
 
-unsigned    Counter::ipi[NUM_IPI];
-unsigned    Counter::lvt[NUM_LVT];
-unsigned    Counter::gsi[NUM_GSI];
-unsigned    Counter::exc[NUM_EXC];
-unsigned    Counter::vmi[NUM_VMI];
-unsigned    Counter::vtlb_gpf;
-unsigned    Counter::vtlb_hpf;
-unsigned    Counter::vtlb_fill;
-unsigned    Counter::vtlb_flush;
-unsigned    Counter::schedule;
-unsigned    Counter::helping;
-uint64      Counter::cycles_idle;
+Counter::Stats  Counter::stats;
+Paddr           Counter::phys;
+
+Spinlock::Stat  Spinlock::stats[NUM_CLASSES];
+
+/*
+ * The statistics pages of all CPUs are contiguous, so that one HIP
+ * memory descriptor covers them.
+ */
+Paddr Counter::page (unsigned cpu)
+{
+    unsigned short const ord = static_cast<unsigned short>(bit_scan_reverse (PAGES));
+
+    if (cpu >= NUM_CPU)
+        return Buddy::ptr_to_phys (Buddy::allocator.alloc (ord, Pd::kern.quota, Buddy::FILL_0));
+
+    if (!phys)
+        phys = Buddy::ptr_to_phys (Buddy::allocator.alloc (static_cast<unsigned short>(ord + bit_scan_reverse (NUM_CPU - 1) + 1), Pd::kern.quota, Buddy::FILL_0));
+
+    return phys + cpu * PAGES * PAGE_SIZE;
+}
 
 void Counter::dump()
 {
     trace (0, "TIME: %16llu", rdtsc());
     trace (0, "IDLE: %16llu", Counter::cycles_idle);
-    trace (0, "VGPF: %16u", Counter::vtlb_gpf);
-    trace (0, "VHPF: %16u", Counter::vtlb_hpf);
-    trace (0, "VFIL: %16u", Counter::vtlb_fill);
-    trace (0, "VFLU: %16u", Counter::vtlb_flush);
-    trace (0, "SCHD: %16u", Counter::schedule);
-    trace (0, "HELP: %16u", Counter::helping);
-
-    Counter::vtlb_gpf = Counter::vtlb_hpf = Counter::vtlb_fill = Counter::vtlb_flush = Counter::schedule = Counter::helping = 0;
+    trace (0, "VGPF: %16llu", Counter::vtlb_gpf);
+    trace (0, "VHPF: %16llu", Counter::vtlb_hpf);
+    trace (0, "VFIL: %16llu", Counter::vtlb_fill);
+    trace (0, "VFLU: %16llu", Counter::vtlb_flush);
+    trace (0, "SCHD: %16llu", Counter::schedule);
+    trace (0, "HELP: %16llu", Counter::helping);
 
     for (unsigned i = 0; i < sizeof (Counter::ipi) / sizeof (*Counter::ipi); i++)
-        if (Counter::ipi[i]) {
-            trace (0, "IPI %#4x: %12u", i, Counter::ipi[i]);
-            Counter::ipi[i] = 0;
-        }
+        if (Counter::ipi[i])
+            trace (0, "IPI %#4x: %12llu", i, Counter::ipi[i]);
 
     for (unsigned i = 0; i < sizeof (Counter::lvt) / sizeof (*Counter::lvt); i++)
-        if (Counter::lvt[i]) {
-            trace (0, "LVT %#4x: %12u", i, Counter::lvt[i]);
-            Counter::lvt[i] = 0;
-        }
+        if (Counter::lvt[i])
+            trace (0, "LVT %#4x: %12llu", i, Counter::lvt[i]);
 
     for (unsigned i = 0; i < sizeof (Counter::gsi) / sizeof (*Counter::gsi); i++)
-        if (Counter::gsi[i]) {
-            trace (0, "GSI %#4x: %12u", i, Counter::gsi[i]);
-            Counter::gsi[i] = 0;
-        }
+        if (Counter::gsi[i])
+            trace (0, "GSI %#4x: %12llu", i, Counter::gsi[i]);
 
     for (unsigned i = 0; i < sizeof (Counter::exc) / sizeof (*Counter::exc); i++)
-        if (Counter::exc[i]) {
-            trace (0, "EXC %#4x: %12u", i, Counter::exc[i]);
-            Counter::exc[i] = 0;
-        }
+        if (Counter::exc[i])
+            trace (0, "EXC %#4x: %12llu", i, Counter::exc[i]);
 
     for (unsigned i = 0; i < sizeof (Counter::vmi) / sizeof (*Counter::vmi); i++)
-        if (Counter::vmi[i]) {
-            trace (0, "VMI %#4x: %12u", i, Counter::vmi[i]);
-            Counter::vmi[i] = 0;
-        }
+        if (Counter::vmi[i])
+            trace (0, "VMI %#4x: %12llu", i, Counter::vmi[i]);
+
+    for (unsigned i = 0; i < Spinlock::NUM_CLASSES; i++)
+        if (Spinlock::stats[i].acquired)
+            trace (0, "LCK %#4x: %12llu %12llu %12llu %12llu", i, Spinlock::stats[i].acquired, Spinlock::stats[i].contended, Spinlock::stats[i].spin, Spinlock::stats[i].hold_max);
+
+    for (unsigned i = 0; i < Sysstat::SYSCALLS; i++)
+        if (Sysstat::stats[i].count)
+            trace (0, "SYS %#4x: %12llu %12llu", i, Sysstat::stats[i].count, Sysstat::stats[i].cycles);
 }
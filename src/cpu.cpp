@@ -280,9 +280,19 @@ void Cpu::init(bool resume)
             Lapic::ap_code_prepare();
     }
 
+    /*
+     * An AP holds boot_lock only while it uses the shared boot stack.
+     * Once on its own stack it lets the next AP in, so that the APs
+     * initialize in parallel. The BSP releases the lock at the end, so
+     * that the APs only start once the global state is set up.
+     */
+    if (!Cpu::bsp)
+        boot_lock++;
+
     /* handle case running on machine with too many CPUs */
     if (id >= NUM_CPU) {
-        boot_lock++;
+        if (Cpu::bsp)
+            boot_lock++;
         shutdown();
     }
 
@@ -310,7 +320,9 @@ void Cpu::init(bool resume)
         Pd::kern.Space_mem::loc[id] = Hptp (Hpt::current());
         Pd::kern.Space_mem::loc[id].lookup (CPU_LOCAL_DATA, phys, attr);
         Pd::kern.Space_mem::insert (Pd::kern.quota, HV_GLOBAL_CPUS + id * PAGE_SIZE, 0, Hpt::HPT_NX | Hpt::HPT_G | Hpt::HPT_W | Hpt::HPT_P, phys);
-        Hpt::ord = min (Hpt::ord, feature (FEAT_1GB_PAGES) ? 26UL : 17UL);
+
+        /* Hpt::ord = min (Hpt::ord, n) with other APs racing */
+        for (mword o, n = feature (FEAT_1GB_PAGES) ? 26UL : 17UL; (o = Hpt::ord) > n && !Atomic::cmp_swap (Hpt::ord, o, n); pause()) ;
     }
 
     if (EXPECT_TRUE (feature (FEAT_ACPI)))
@@ -375,5 +387,6 @@ void Cpu::init(bool resume)
 
     Cpu::mwait_hint = ~0U; /* invalid */
 
-    boot_lock++;
+    if (Cpu::bsp)
+        boot_lock++;
 }
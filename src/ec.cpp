@@ -115,7 +115,7 @@ Ec::Ec (Pd *own, mword sel, Pd *p, void (*f)(), unsigned c, unsigned e, mword u,
                 pd->asid = Space_mem::asid_alloc.alloc();
 
             auto vmcb = new (pd->quota) Vmcb (pd->quota, pd->Space_pio::walk(pd->quota),
-                                              pd->npt.root(pd->quota), unsigned(pd->asid));
+                                              pd->npt.root(pd->quota, Hpt::max() - 1, Quota::KIND_NPT), unsigned(pd->asid));
 
             regs.vmcb_state = new (pd->quota) Vmcb_state(*vmcb, cpu);
 
@@ -194,6 +194,9 @@ Ec::~Ec()
     if (fpu)
         Fpu::destroy(fpu, *pd);
 
+    if (vmstat)
+        Vmstat::destroy(vmstat, pd->quota);
+
     if (this->time > this->time_m)
         Atomic::add(Ec::killed_time[this->cpu], this->time - this->time_m);
 
@@ -308,6 +311,8 @@ void Ec::ret_user_sysexit()
         send_msg<Ec::ret_user_sysexit>();
     }
 
+    Sysstat::left();
+
     asm volatile ("lea %0," EXPAND (PREG(sp); LOAD_GPR RET_USER_HYP) : : "m" (current->regs) : "memory");
 
     UNREACHED;
@@ -320,6 +325,8 @@ void Ec::ret_user_iret()
     if (EXPECT_FALSE (hzd))
         handle_hazard (hzd, ret_user_iret);
 
+    Sysstat::left();
+
     asm volatile ("lea %0," EXPAND (PREG(sp); LOAD_GPR LOAD_SEG RET_USER_EXC) : : "m" (current->regs) : "memory");
 
     UNREACHED;
@@ -338,6 +345,9 @@ void Ec::chk_kern_preempt()
 
 void Ec::ret_user_vmresume()
 {
+    if (EXPECT_FALSE (current->vmstat))
+        current->vmstat->resumed();
+
     mword hzd = (Cpu::hazard | current->regs.hazard()) & (HZD_RECALL | HZD_TSC | HZD_TSC_AUX | HZD_RCU | HZD_SCHED);
     if (EXPECT_FALSE (hzd))
         handle_hazard (hzd, ret_user_vmresume);
@@ -357,6 +367,11 @@ void Ec::ret_user_vmresume()
 
     Fpu::State_xsv::make_current (Fpu::hst_xsv, current->regs.gst_xsv);    // Restore XSV guest state
 
+    if (EXPECT_FALSE (current->vmstat))
+        current->vmstat->entered();
+
+    Sysstat::left();
+
     asm volatile ("lea %0," EXPAND (PREG(sp); LOAD_GPR)
                   "vmresume;"
                   "vmlaunch;"
@@ -372,6 +387,9 @@ void Ec::ret_user_vmresume()
 
 void Ec::ret_user_vmrun()
 {
+    if (EXPECT_FALSE (current->vmstat))
+        current->vmstat->resumed();
+
     mword hzd = (Cpu::hazard | current->regs.hazard()) & (HZD_RECALL | HZD_TSC | HZD_TSC_AUX | HZD_RCU | HZD_SCHED);
     if (EXPECT_FALSE (hzd))
         handle_hazard (hzd, ret_user_vmrun);
@@ -388,6 +406,11 @@ void Ec::ret_user_vmrun()
 
     Fpu::State_xsv::make_current (Fpu::hst_xsv, current->regs.gst_xsv);    // Restore XSV guest state
 
+    if (EXPECT_FALSE (current->vmstat))
+        current->vmstat->entered();
+
+    Sysstat::left();
+
     asm volatile ("lea %0," EXPAND (PREG(sp); LOAD_GPR)
                   "clgi;"
                   "sti;"
@@ -414,6 +437,11 @@ void Ec::idle()
         if (EXPECT_FALSE (hzd))
             handle_hazard (hzd, idle);
 
+        Sysstat::left();
+
+        if (Console::flush())
+            continue;
+
         uint64 t1 = rdtsc();
 
         Cpu::halt_or_mwait([&]() {
@@ -433,11 +461,13 @@ void Ec::idle()
 void Ec::root_invoke()
 {
     /* transfer memory from second allocator */
-    Quota tmp;
-    bool ok = Quota::init.transfer_to(tmp, Quota::init.limit());
-    assert(ok);
-    ok = tmp.transfer_to(Pd::root.quota, tmp.limit());
-    assert(ok);
+    {
+        Quota tmp;
+        bool ok = Quota::init.transfer_to(tmp, Quota::init.limit());
+        assert(ok);
+        ok = tmp.transfer_to(Pd::root.quota, tmp.limit());
+        assert(ok);
+    }
 
     Eh *e = static_cast<Eh *>(Hpt::remap (Pd::kern.quota, Hip::root_addr));
     if (!Hip::root_addr || e->ei_magic != 0x464c457f || e->ei_class != ELF_CLASS || e->ei_data != 1 || e->type != 2 || e->machine != ELF_MACHINE)
@@ -552,8 +582,10 @@ void Ec::die (char const *reason, Exc_regs *r)
 
     Ec *ec = current->rcap;
 
-    if (ec)
-        ec->cont = (ec->cont == ret_user_sysexit || ec->cont == xcpu_return)
+    if (ec && ec->cont == ret_call_async)
+        ec->regs.set_status (Sys_regs::COM_ABT);
+    else if (ec)
+        ec->cont = (ec->cont == ret_user_sysexit || ec->cont == xcpu_return || ec->cont == ret_call_vec)
                  ? static_cast<void (*)()>(sys_finish<Sys_regs::COM_ABT>)
                  : dead;
 
@@ -611,6 +643,59 @@ void Ec::xcpu_revert(void (*sm_cont)())
     sm->up (sm_cont);
 }
 
+/*
+ * Pick a proxy for a cross-CPU call to tcpu. An idle proxy last bound to
+ * tcpu is preferred, then any idle proxy, then an unallocated slot. A
+ * proxy which just replied may still be leaving its remote CPU, in which
+ * case another slot is used instead of waiting for it.
+ */
+Ec::Xcpu_proxy *Ec::xcpu_proxy_select(unsigned const tcpu)
+{
+    Xcpu_proxy *idle = nullptr, *none = nullptr;
+
+    for (auto &proxy : xcpu_proxy) {
+        switch (proxy.state()) {
+        case Xcpu_proxy::IDLE:
+            if (proxy.ec->cpu == tcpu)
+                return &proxy;
+            if (!idle)
+                idle = &proxy;
+            break;
+        case Xcpu_proxy::NONE:
+            if (!none)
+                none = &proxy;
+            break;
+        case Xcpu_proxy::BUSY:
+            break;
+        }
+    }
+
+    return idle ? idle : none;
+}
+
+void Ec::xcpu_proxy_free()
+{
+    for (auto &proxy : xcpu_proxy) {
+        if (proxy.ec) {
+            auto ec = proxy.ec;
+            proxy.ec = nullptr;
+            Rcu::call(ec);
+        }
+
+        if (proxy.sc) {
+            auto sc = proxy.sc;
+            proxy.sc = nullptr;
+            Rcu::call(sc);
+        }
+    }
+
+    if (sm_xcpu) {
+        auto sm = sm_xcpu;
+        sm_xcpu = nullptr;
+        Rcu::call(sm);
+    }
+}
+
 void Ec::idl_handler()
 {
     if (Ec::current->cont == Ec::idle)
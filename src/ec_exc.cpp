@@ -183,8 +183,12 @@ bool Ec::handle_exc_pf (Exc_regs *r)
 {
     mword addr = r->cr2;
 
-    if (r->err & Hpt::ERR_U)
+    if (r->err & Hpt::ERR_U) {
+        if (addr < USER_ADDR && (r->err & (Hpt::ERR_W | Hpt::ERR_P)) == (Hpt::ERR_W | Hpt::ERR_P) && Pd::current->cow_fault (addr))
+            return true;
+
         return addr < USER_ADDR && Pd::current->Space_mem::loc[Cpu::id].sync_user (Pd::current->quota, Pd::current->Space_mem::hpt, addr);
+    }
 
     if (addr < USER_ADDR) {
 
@@ -183,6 +183,10 @@ void Ec::handle_svm()
             reason = VM_EXIT_NPT;
             current->regs.nst_error = static_cast<mword>(vmcb.exitinfo1);
             current->regs.nst_fault = static_cast<mword>(vmcb.exitinfo2);
+
+            /* write to a present page: copy-on-write */
+            if ((current->regs.nst_error & 0x3) == 0x3 && Pd::current->cow_fault (current->regs.nst_fault))
+                ret_user_vmrun();
             break;
         default:
             reason = static_cast<mword>(vmcb.exitcode);
@@ -199,6 +203,11 @@ void Ec::handle_svm()
     if (reason < NUM_VMI)
         Counter::vmi[reason]++;
 
+    if (EXPECT_FALSE (current->vmstat))
+        current->vmstat->exited (reason);
+
+    Tracebuf::log (Tracebuf::EVT_VMEXIT, reinterpret_cast<mword>(current), reason);
+
     switch (reason) {
 
         case 0x0 ... 0x1f:      // CR Access
@@ -204,6 +204,11 @@ void Ec::handle_vmx()
 
     Counter::vmi[reason]++;
 
+    if (EXPECT_FALSE (current->vmstat))
+        current->vmstat->exited (reason);
+
+    Tracebuf::log (Tracebuf::EVT_VMEXIT, reinterpret_cast<mword>(current), reason);
+
     switch (reason) {
         case Vmcs::VMX_EXC_NMI:     vmx_exception();
         case Vmcs::VMX_EXTINT:      vmx_extint();
@@ -214,6 +219,10 @@ void Ec::handle_vmx()
         case Vmcs::VMX_EPT_VIOLATION:
             current->regs.nst_error = Vmcs::read (Vmcs::EXI_QUALIFICATION);
             current->regs.nst_fault = Vmcs::read (Vmcs::INFO_PHYS_ADDR);
+
+            /* write to a readable page: copy-on-write */
+            if ((current->regs.nst_error & 0xa) == 0xa && Pd::current->cow_fault (current->regs.nst_fault))
+                ret_user_vmresume();
             break;
     }
 
@@ -20,9 +20,12 @@
  */
 
 #include "fpu.hpp"
+#include "lock_guard.hpp"
 
 Fpu::State_xsv Fpu::hst_xsv;
 
+static Spinlock probe_lock;
+
 ALIGNED(Fpu::alignment) static Fpu empty;
 
 void Fpu::init()
@@ -112,6 +115,9 @@ void Fpu::probe()
     unsigned size = 0, dummy = 0; 
     Cpu::cpuid (0xd, compact, dummy, size, dummy, dummy);
 
+    /* APs probe in parallel */
+    Lock_guard <Spinlock> guard (probe_lock);
+
     /* Use largest context size reported by any CPU */
     Fpu::size = max (Fpu::size, static_cast<size_t>(size));
 
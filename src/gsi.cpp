@@ -27,6 +27,7 @@
 #include "keyb.hpp"
 #include "lapic.hpp"
 #include "sm.hpp"
+#include "tracebuf.hpp"
 #include "vectors.hpp"
 
 Gsi         Gsi::gsi_table[NUM_GSI];
@@ -101,5 +102,7 @@ void Gsi::vector (unsigned vector)
 
     gsi_table[gsi].sm->submit();
 
+    Tracebuf::log (Tracebuf::EVT_IRQ, gsi);
+
     Counter::print<1,16> (++Counter::gsi[gsi], Console_vga::Color (Console_vga::COLOR_LIGHT_YELLOW - gsi / 64), SPN_GSI + gsi % 64);
 }
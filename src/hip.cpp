@@ -20,6 +20,7 @@
  */
 
 #include "cmdline.hpp"
+#include "counter.hpp"
 #include "cpu.hpp"
 #include "hip.hpp"
 #include "hpt.hpp"
@@ -31,6 +32,7 @@
 #include "acpi_rsdp.hpp"
 #include "acpi.hpp"
 #include "string.hpp"
+#include "tracebuf.hpp"
 
 extern char _mempool_e;
 
@@ -272,6 +274,26 @@ void Hip::add_check()
         mem++;
     }
 
+    if (Counter::phys) {
+        mem->addr = Counter::phys;
+        mem->size = Cpu::online * Counter::PAGES * PAGE_SIZE;
+        mem->type = Hip_mem::HYP_STATS;
+        mem->aux  = Counter::PAGES * PAGE_SIZE;
+
+        /* Let the root PD map the statistics pages read-only */
+        Pd::kern.Space_mem::insert_root (Pd::kern.quota, Pd::kern.mdb_cache, mem->addr, mem->addr + mem->size, 0x1);
+
+        mem++;
+    }
+
+    if (Tracebuf::phys) {
+        mem->addr = Tracebuf::phys;
+        mem->size = Tracebuf::size;
+        mem->type = Hip_mem::HYP_TRACE;
+        mem->aux  = PAGE_SIZE << Tracebuf::ORD;
+        mem++;
+    }
+
     h->length = static_cast<uint16>(reinterpret_cast<mword>(mem) - reinterpret_cast<mword>(h));
 
     h->freq_tsc = Lapic::freq_tsc;
@@ -389,15 +411,10 @@ void Hip::_add_buddy (Hip_mem *&mem, Hip * hip, uint64 const system_mem_max,
     if (!buddy_size)
         return;
 
-    for (unsigned i = 0; i < (buddy_size / PAGE_SIZE); i++) {
-        Paddr const p_buddy = buddy_start + i * PAGE_SIZE;
-        Pd::kern.Space_mem::delreg(Pd::kern.quota, Pd::kern.mdb_cache, p_buddy);
-
-        if (!(p_buddy & mask))
-            Pd::kern.Space_mem::insert (Pd::kern.quota, v_buddy + i * PAGE_SIZE, mem_log - 12, Hpt::HPT_NX | Hpt::HPT_G | Hpt::HPT_W | Hpt::HPT_P, p_buddy);
-    }
+    Pd::kern.Space_mem::delreg(Pd::kern.quota, Pd::kern.mdb_cache, buddy_start, static_cast<size_t>(buddy_size));
 
-    memset(reinterpret_cast<void *>(v_buddy), 0, static_cast<mword>(buddy_size));
+    for (mword i = 0; i < buddy_size; i += static_cast<mword>(mask_size))
+        Pd::kern.Space_mem::insert (Pd::kern.quota, v_buddy + i, mem_log - 12, Hpt::HPT_NX | Hpt::HPT_G | Hpt::HPT_W | Hpt::HPT_P, buddy_start + i);
 
     /* allocate new buddy */
     new (Pd::kern.quota) Buddy(buddy_start, v_buddy, v_buddy, static_cast<mword>(buddy_size));
@@ -23,6 +23,7 @@
 #include "console_mem.hpp"
 #include "console_serial.hpp"
 #include "console_vga.hpp"
+#include "counter.hpp"
 #include "gsi.hpp"
 #include "hip.hpp"
 #include "hpt.hpp"
@@ -68,6 +69,12 @@ mword kern_ptab_setup()
                 Buddy::ptr_to_phys (Buddy::allocator.alloc (0, Pd::kern.quota, Buddy::FILL_0)),
                 Hpt::HPT_NX | Hpt::HPT_G | Hpt::HPT_W | Hpt::HPT_P);
 
+    // Map statistics pages
+    Paddr const stat = Counter::page (cpuid);
+    for (unsigned i = 0; i < Counter::PAGES; i++)
+        hpt.update (Pd::kern.quota, CPU_LOCAL_STAT + i * PAGE_SIZE, 0, stat + i * PAGE_SIZE,
+                    Hpt::HPT_NX | Hpt::HPT_G | Hpt::HPT_W | Hpt::HPT_P);
+
     // Sync kernel code and data
     hpt.sync_master_range (Pd::kern.quota, LINK_ADDR, CPU_LOCAL);
 
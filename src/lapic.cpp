@@ -25,6 +25,7 @@
 #include "hip.hpp"
 #include "lapic.hpp"
 #include "msr.hpp"
+#include "pmu.hpp"
 #include "rcu.hpp"
 #include "stdio.hpp"
 #include "timeout.hpp"
@@ -201,7 +202,13 @@ void Lapic::send_ipi (unsigned cpu, unsigned vector, Delivery_mode dlv, Shorthan
 
 void Lapic::therm_handler() {}
 
-void Lapic::perfm_handler() {}
+void Lapic::perfm_handler (Exc_regs const *r)
+{
+    Pmu::sample (r);
+
+    /* Intel masks the LVT entry on overflow */
+    set_lvt (LAPIC_LVT_PERFM, DLV_FIXED, VEC_LVT_PERFM);
+}
 
 void Lapic::error_handler()
 {
@@ -218,14 +225,19 @@ void Lapic::timer_handler()
     Rcu::update();
 }
 
-void Lapic::lvt_vector (unsigned vector)
+void Lapic::lvt_handler (Exc_regs const *r)
+{
+    lvt_vector (static_cast<unsigned>(r->vec), r);
+}
+
+void Lapic::lvt_vector (unsigned vector, Exc_regs const *r)
 {
     unsigned lvt = vector - VEC_LVT;
 
     switch (vector) {
         case VEC_LVT_TIMER: timer_handler(); break;
         case VEC_LVT_ERROR: error_handler(); break;
-        case VEC_LVT_PERFM: perfm_handler(); break;
+        case VEC_LVT_PERFM: perfm_handler (r); break;
         case VEC_LVT_THERM: therm_handler(); break;
     }
 
@@ -268,7 +280,7 @@ bool Lapic::hlt_other_cpus()
         if (Cpu::id == cpu)
             continue;
 
-        unsigned ctr = Counter::remote (cpu, VEC_IPI_HLT - VEC_IPI);
+        mword ctr = Counter::remote (cpu, VEC_IPI_HLT - VEC_IPI);
 
         Lapic::send_ipi (cpu, VEC_IPI_HLT);
 
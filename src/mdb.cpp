@@ -20,16 +20,20 @@
 #include "lock_guard.hpp"
 #include "mdb.hpp"
 
-Spinlock Mdb::lock;
+Spinlock Mdb::lock { Spinlock::LOCK_MDB };
 
-bool Mdb::insert_node (Mdb *p, mword a)
+/*
+ * Attributes in k are granted even if the parent lacks them, for nodes
+ * whose mappings never expose them through the parent's frame
+ */
+bool Mdb::insert_node (Mdb *p, mword a, mword k)
 {
     Lock_guard <Spinlock> guard (lock);
 
     if (!p->alive())
         return false;
 
-    if (!(node_attr = p->node_attr & a))
+    if (!(node_attr = static_cast<uint8>((p->node_attr | k) & a)))
         return false;
 
     prev = prnt = p;
@@ -43,7 +47,7 @@ void Mdb::demote_node (mword a)
 {
     Lock_guard <Spinlock> guard (lock);
 
-    node_attr &= ~a;
+    node_attr = static_cast<uint8>(node_attr & ~a);
 }
 
 bool Mdb::remove_node(bool leaf)
@@ -26,6 +26,8 @@
 #include "ec.hpp"
 #include "pt.hpp"
 #include "sm.hpp"
+#include "svm.hpp"
+#include "utcb.hpp"
 
 INIT_PRIORITY (PRIO_SLAB)
 Slab_cache Pd::cache (sizeof (Pd), 32);
@@ -77,8 +79,10 @@ bool Pd::delegate (Pd *snd, mword const snd_base, mword const rcv_base, mword co
 
     Quota_guard qg(this->quota);
 
-    Mdb *mdb;
-    for (mword addr = snd_base; (mdb = snd->S::tree_lookup (addr, true)); addr = mdb->node_base + (1UL << mdb->node_order)) {
+    Mdb *mdb, *hint = nullptr;
+    for (mword addr = snd_base; (mdb = snd->S::tree_next (hint, addr)); addr = mdb->node_base + (1UL << mdb->node_order)) {
+
+        hint = ACCESS_ONCE (mdb->succ);
 
         mword o, b = snd_base;
         if ((o = clamp (mdb->node_base, b, mdb->node_order, ord)) == ~0UL)
@@ -130,10 +134,19 @@ bool Pd::delegate (Pd *snd, mword const snd_base, mword const rcv_base, mword co
 }
 
 template <typename S>
-void Pd::revoke (mword const base, mword const ord, mword const attr, bool self, bool kim)
+bool Pd::revoke (mword const base, mword const ord, mword const attr, bool self, bool kim, mword *resume)
 {
-    Mdb *mdb;
-    for (mword addr = base; (mdb = S::tree_lookup (addr, true)); addr = mdb->node_base + (1UL << mdb->node_order)) {
+    Mdb *mdb, *hint = nullptr;
+    mword const start = resume ? max (base, *resume) : base;
+    for (mword addr = start; (mdb = S::tree_next (hint, addr)); addr = mdb->node_base + (1UL << mdb->node_order)) {
+
+        hint = ACCESS_ONCE (mdb->succ);
+
+        /* once a node is done, record progress and stop between top-level nodes if a reschedule is pending */
+        if (resume && addr != start && (Cpu::hazard & HZD_SCHED)) {
+            *resume = addr;
+            return false;
+        }
 
         mword o, p, b = base;
         if ((o = clamp (mdb->node_base, b, mdb->node_order, ord)) == ~0UL)
@@ -222,6 +235,8 @@ void Pd::revoke (mword const base, mword const ord, mword const attr, bool self,
         this->flush_pgt();
         Cpu::hazard &= ~unsigned(HZD_IOMMU);
     }
+
+    return true;
 }
 
 mword Pd::clamp (mword snd_base, mword &rcv_base, mword snd_ord, mword rcv_ord)
@@ -299,7 +314,7 @@ void Pd::xlt_crd (Pd *pd, Crd xlt, Crd &crd)
     crd = Crd (0);
 }
 
-void Pd::del_crd (Pd *pd, Crd del, Crd &crd, mword sub, mword hot)
+void Pd::del_crd (Pd *pd, Crd del, Crd &crd, mword sub, mword hot, mword &flush)
 {
     Crd::Type st = crd.type(), rt = del.type();
     bool s = false;
@@ -339,14 +354,25 @@ void Pd::del_crd (Pd *pd, Crd del, Crd &crd, mword sub, mword hot)
         this->htlb.merge (cpus);
 
     if (s && sub & 0x1)
-        this->flush_pgt();
+        flush |= FLUSH_IOMMU;
 
     if (s)
+        flush |= FLUSH_TLB;
+}
+
+void Pd::flush_deferred (mword flush)
+{
+    if (flush & FLUSH_IOMMU)
+        this->flush_pgt();
+
+    if (flush & FLUSH_TLB)
         shootdown(this);
 }
 
-void Pd::rev_crd (Crd crd, bool self, bool preempt, bool kim)
+bool Pd::rev_crd (Crd crd, bool self, bool preempt, bool kim, mword *resume)
 {
+    bool done = true;
+
     if (preempt)
         Cpu::preempt_enable();
 
@@ -354,17 +380,17 @@ void Pd::rev_crd (Crd crd, bool self, bool preempt, bool kim)
 
         case Crd::MEM:
             trace (TRACE_REV, "REV MEM PD:%p B:%#010lx O:%#04x A:%#04x %s", this, crd.base(), crd.order(), crd.attr(), self ? "+" : "-");
-            revoke<Space_mem>(crd.base(), crd.order(), crd.attr(), self, kim);
+            done = revoke<Space_mem>(crd.base(), crd.order(), crd.attr(), self, kim, resume);
             break;
 
         case Crd::PIO:
             trace (TRACE_REV, "REV I/O PD:%p B:%#010lx O:%#04x A:%#04x %s", this, crd.base(), crd.order(), crd.attr(), self ? "+" : "-");
-            revoke<Space_pio>(crd.base(), crd.order(), crd.attr(), self, kim);
+            done = revoke<Space_pio>(crd.base(), crd.order(), crd.attr(), self, kim, resume);
             break;
 
         case Crd::OBJ:
             trace (TRACE_REV, "REV OBJ PD:%p B:%#010lx O:%#04x A:%#04x %s", this, crd.base(), crd.order(), crd.attr(), self ? "+" : "-");
-            revoke<Space_obj>(crd.base(), crd.order(), crd.attr(), self, kim);
+            done = revoke<Space_obj>(crd.base(), crd.order(), crd.attr(), self, kim, resume);
             break;
     }
 
@@ -378,11 +404,328 @@ void Pd::rev_crd (Crd crd, bool self, bool preempt, bool kim)
 
     if (crd.type() == Crd::MEM)
         shootdown(this);
+
+    return done;
+}
+
+static void free_cow (Rcu_elem * e)
+{
+    Mdb *mdb = static_cast<Mdb *>(e);
+    Pd  *pd  = static_cast<Pd *>(static_cast<Space_mem *>(mdb->space));
+
+    Buddy::allocator.free (reinterpret_cast<mword>(Buddy::phys_to_ptr (static_cast<Paddr>(mdb->node_phys) << PAGE_BITS)), pd->quota);
+    Mdb::destroy (mdb, pd->quota, pd->mdb_cache);
+}
+
+/*
+ * Resolve a write fault on a copy-on-write mapping: the page gets a
+ * private copy charged to this PD, the rest of the node is split into
+ * naturally aligned read-only nodes that keep sharing the frames. All of
+ * them stay derived from the parent. As copy-on-write nodes are mapped
+ * with leaf entries only, the split nodes take over the existing entries
+ * in place and only the faulting page changes its mapping.
+ */
+bool Pd::cow_fault (mword const addr)
+{
+    mword const page = addr >> PAGE_BITS;
+
+    Lock_guard <Spinlock> guard (cow_lock);
+
+    Mdb *mdb = Space_mem::tree_lookup (page);
+    if (!mdb)
+        return false;
+
+    /* resolved by another CPU meanwhile */
+    if (mdb->func == free_cow)
+        return true;
+
+    /* nodes delegated onwards keep sharing their frames */
+    if (!(mdb->node_sub & SUB_COW) || !(mdb->node_attr & 0x2) || !mdb->prnt || ACCESS_ONCE (mdb->next)->dpth > mdb->dpth)
+        return false;
+
+    mword const ord = mdb->node_order;
+
+    if (quota.hit_limit (ord + 2))
+        return false;
+
+    void *frame = Buddy::allocator.alloc (0, quota, Buddy::NOFILL);
+    if (!frame)
+        return false;
+
+    memcpy (frame, Hpt::remap (Pd::kern.quota, static_cast<Paddr>(mdb->node_phys + page - mdb->node_base) << PAGE_BITS), PAGE_SIZE);
+
+    Quota_guard qg (quota);
+
+    Mdb  *parent = mdb->prnt;
+    mword attr = mdb->node_attr, b = mdb->node_base, p = mdb->node_phys;
+
+    /* the page-table entries stay, the split nodes take them over */
+    mdb->demote_node (0x1f);
+
+    if (!mdb->remove_node() || !Space_mem::tree_remove (mdb)) {
+        Space_mem::update (qg, mdb, 0x1f);
+        Buddy::allocator.free (reinterpret_cast<mword>(frame), quota);
+        shootdown (this);
+        return true;
+    }
+
+    /* nodes that cannot be inserted drop their entries */
+    for (mword o = ord; o--; ) {
+
+        mword const half = 1UL << o, ofs = (page - b) & half ? 0 : half;
+
+        Mdb *node = new (qg, mdb_cache) Mdb (static_cast<Space_mem *>(this), free_mdb<Space_mem>, p + ofs, b + ofs, o, 0, mdb->node_type, mdb->node_sub, mdb->dpth);
+
+        if (!Space_mem::tree_insert (node)) {
+            Space_mem::update (qg, node, 0x1f);
+            Mdb::destroy (node, qg, mdb_cache);
+        } else if (!node->insert_node (parent, attr, attr & 0x2)) {
+            Space_mem::update (qg, node, 0x1f);
+            if (Space_mem::tree_remove (node))
+                Rcu::call (node);
+        } else
+            Space_mem::update (qg, node);
+
+        if (!ofs) {
+            b += half;
+            p += half;
+        }
+    }
+
+    /* writable even below a read-only parent, as it has a frame of its own */
+    Mdb *copy = new (qg, mdb_cache) Mdb (static_cast<Space_mem *>(this), free_cow, Buddy::ptr_to_phys (frame) >> PAGE_BITS, page, 0, 0, mdb->node_type, mdb->node_sub & ~mword(SUB_COW), mdb->dpth);
+
+    if (!Space_mem::tree_insert (copy)) {
+        Space_mem::update (qg, copy, 0x1f);
+        Rcu::call (copy);
+    } else if (!copy->insert_node (parent, attr, attr & 0x2)) {
+        Space_mem::update (qg, copy, 0x1f);
+        if (Space_mem::tree_remove (copy))
+            Rcu::call (copy);
+    } else
+        Space_mem::update (qg, copy);
+
+    Rcu::call (mdb);
+
+    shootdown (this);
+
+    return true;
+}
+
+/*
+ * Whether no user mapping of the frame of s is writable, in which case the
+ * TLBs of all PDs mapping it are flushed to drop write permissions that a
+ * concurrent revoke has not shot down yet. All mappings of the frame derive
+ * from the topmost node covering it below the kernel, and subtrees of nodes
+ * not covering the frame are skipped, their nodes cannot cover it either.
+ */
+static bool read_only (Mdb *s, mword const frame)
+{
+    auto cover = [frame] (Mdb const *m) { return frame - m->node_phys < 1UL << m->node_order; };
+
+    Mdb *r = s;
+    for (Mdb *p; r->dpth > 1 && cover (p = ACCESS_ONCE (r->prnt)); r = p) ;
+
+    for (Mdb *m = r, *n;; m = n) {
+
+        bool const c = cover (m);
+
+        if (c) {
+            if ((m->node_attr & 0x2) && !(m->node_sub & Space_mem::SUB_COW))
+                return false;
+
+            Space_mem::shootdown (static_cast<Pd *>(static_cast<Space_mem *>(m->space)));
+        }
+
+        for (n = ACCESS_ONCE (m->next); !c && n->dpth > m->dpth; n = ACCESS_ONCE (n->next)) ;
+
+        if (n->dpth <= r->dpth)
+            return true;
+    }
+}
+
+/*
+ * Replace the page dp of this PD by a copy-on-write mapping of the frame
+ * behind page sp of src, if both have identical contents. No user mapping
+ * of that frame may be writable, so that it cannot change while compared
+ * or shared: the caller revokes write access from its own mappings first.
+ * The new node is derived from the src node but keeps the write permission
+ * of dp, which is withheld from the page table until a write fault gives
+ * this PD a private copy again.
+ */
+Pd::Merge Pd::merge_page (Pd *src, mword const sp, mword const dp)
+{
+    Lock_guard <Spinlock> guard (cow_lock);
+
+    Mdb *s = src->Space_mem::tree_lookup (sp), *d = Space_mem::tree_lookup (dp);
+
+    if (!s || !d || s == d || !s->prnt || (s->node_sub & 0x1) || (s->node_attr & 0x2))
+        return MERGE_BAD;
+
+    if (d->node_order || (d->node_sub & 0x1) || !d->prnt || ACCESS_ONCE (d->next)->dpth > d->dpth)
+        return MERGE_BAD;
+
+    mword frame = s->node_phys + sp - s->node_base;
+
+    if (d->node_phys == frame)
+        return MERGE_DONE;
+
+    if (!read_only (s, frame))
+        return MERGE_BAD;
+
+    if (quota.hit_limit (2))
+        return MERGE_OOM;
+
+    void *buf = Buddy::allocator.alloc (0, quota, Buddy::NOFILL);
+    if (!buf)
+        return MERGE_OOM;
+
+    memcpy (buf, Hpt::remap (Pd::kern.quota, static_cast<Paddr>(frame) << PAGE_BITS), PAGE_SIZE);
+
+    Quota_guard qg (quota);
+
+    /* no writes to the page while comparing */
+    Space_mem::update (qg, d, 0x2);
+    shootdown (this);
+
+    mword const *a = static_cast<mword *>(buf);
+    mword const *b = static_cast<mword *>(Hpt::remap (Pd::kern.quota, static_cast<Paddr>(d->node_phys) << PAGE_BITS));
+
+    bool same = true;
+    for (unsigned i = 0; same && i < PAGE_SIZE / sizeof (mword); i++)
+        same = a[i] == b[i];
+
+    Buddy::allocator.free (reinterpret_cast<mword>(buf), quota);
+
+    Mdb *node = same ? new (qg, mdb_cache) Mdb (static_cast<Space_mem *>(this), free_mdb<Space_mem>, frame, dp, 0, 0, s->node_type, Space_mem::sticky_sub (s->node_sub) | (d->node_sub & 0x2) | SUB_COW, static_cast<uint16>(s->dpth + 1)) : nullptr;
+
+    if (!node) {
+        Space_mem::update (qg, d);
+        return same ? MERGE_OOM : MERGE_DIFF;
+    }
+
+    mword attr = d->node_attr;
+
+    /* the new node enters the mapping database before dp leaves it, the src node is being revoked otherwise */
+    if (!node->insert_node (s, attr, attr & 0x2)) {
+        Mdb::destroy (node, qg, mdb_cache);
+        Space_mem::update (qg, d);
+        return MERGE_BAD;
+    }
+
+    d->demote_node (0x1f);
+
+    /* dp is being revoked or was delegated meanwhile */
+    if (!d->remove_node()) {
+        Space_mem::update (qg, d, 0x1f);
+        node->demote_node (0x1f);
+        if (node->remove_node())
+            Rcu::call (node);
+        shootdown (this);
+        return MERGE_BAD;
+    }
+
+    Space_mem::tree_replace (d, node);
+
+    Rcu::call (d);
+
+    Space_mem::update (qg, node);
+
+    shootdown (this);
+
+    return MERGE_DONE;
+}
+
+/*
+ * Report and clear the accessed bits of n pages starting at addr in the
+ * host or nested page table, one bit per page in the UTCB. The TLBs are
+ * flushed once for the whole range. Returns the number of accessed pages
+ * or ~0UL if the page table keeps no accessed bits.
+ */
+mword Pd::harvest (mword const addr, mword n, bool const guest, Utcb *utcb)
+{
+    if (guest && !Vmcb::has_npt())
+        return ~0UL;
+
+    if (!guest && (addr >= USER_ADDR || n > (USER_ADDR - addr) >> PAGE_BITS))
+        n = addr >= USER_ADDR ? 0 : (USER_ADDR - addr) >> PAGE_BITS;
+
+    Hpt &pt = guest ? Space_mem::npt : Space_mem::hpt;
+
+    mword cnt = 0;
+
+    for (mword i = 0; i < n;) {
+
+        mword const v = addr + (i << PAGE_BITS);
+
+        bool a = false;
+        size_t s = pt.harvest (v, Hpt::HPT_A, a);
+
+        /* a superpage is reported for all of its pages in the range */
+        mword pages = s ? (s - (v & (s - 1))) >> PAGE_BITS : 1;
+
+        for (; pages-- && i < n; i++) {
+            utcb->bitmap (i, a);
+            cnt += a;
+        }
+    }
+
+    if (cnt) {
+        if (guest)
+            gtlb.merge (cpus);
+        else
+            htlb.merge (cpus);
+
+        shootdown (this);
+    }
+
+    return cnt;
+}
+
+/*
+ * Page tables are counted by what was charged to the quota for them, objects
+ * by the slabs of their caches. Only the top level of the per-CPU copies of
+ * the host page table is walked, the tables below it are charged as host
+ * page-table memory. Whatever cannot be attributed is reported as other.
+ */
+void Pd::kmem (mword (&k)[KMEM_MAX])
+{
+    k[KMEM_EC]   = ec_cache.pages;
+    k[KMEM_SC]   = sc_cache.pages;
+    k[KMEM_PT]   = pt_cache.pages;
+    k[KMEM_SM]   = sm_cache.pages;
+    k[KMEM_MDB]  = mdb_cache.pages;
+    k[KMEM_FPU]  = fpu_cache.pages;
+
+    k[KMEM_LOC]  = 0;
+
+    for (unsigned cpu = 0; cpu < NUM_CPU; cpu++)
+        if (Hip::cpu_online (cpu))
+            k[KMEM_LOC] += Space_mem::loc[cpu].pages (Space_mem::hpt.dest_loc, Space_mem::hpt.iter_loc_lev);
+
+    mword const h = quota.usage (Quota::KIND_HPT);
+
+    k[KMEM_HPT]  = h > k[KMEM_LOC] ? h - k[KMEM_LOC] : 0;
+    k[KMEM_NPT]  = quota.usage (Quota::KIND_NPT);
+    k[KMEM_DPT]  = quota.usage (Quota::KIND_DPT);
+
+    k[KMEM_VTLB] = quota.usage (Quota::KIND_VTLB);
+    k[KMEM_UTCB] = quota.usage (Quota::KIND_UTCB);
+    k[KMEM_VCPU] = quota.usage (Quota::KIND_VCPU);
+
+    mword sum = 0;
+
+    for (unsigned i = 0; i < KMEM_OTHER; i++)
+        sum += k[i];
+
+    mword const used = quota.usage();
+
+    k[KMEM_OTHER] = used > sum ? used - sum : 0;
 }
 
 void Pd::xfer_items (Pd *src, Crd xlt, Crd del, Xfer *s, Xfer *d, unsigned long ti)
 {
-    mword set_as_del;
+    mword set_as_del, flush = 0;
 
     for (Crd crd; ti--; s--) {
 
@@ -406,9 +749,17 @@ void Pd::xfer_items (Pd *src, Crd xlt, Crd del, Xfer *s, Xfer *d, unsigned long
 
             case 1: {
                 bool r = src == &root && s->flags() & 0x800;
-                del_crd (r? &kern : src, del, crd, (s->flags() >> 8) & (r ? 7 : 3), s->hotspot());
-                if (Cpu::hazard & HZD_OOM)
+                mword sub = (s->flags() >> 8) & (r ? 7 : 3);
+
+                /* copy-on-write mappings are not accessible by devices */
+                if (s->flags() & 0x10 && crd.type() == Crd::MEM)
+                    sub = (sub & ~1UL) | SUB_COW;
+
+                del_crd (r? &kern : src, del, crd, sub, s->hotspot(), flush);
+                if (Cpu::hazard & HZD_OOM) {
+                    flush_deferred (flush);
                     return;
+                }
                 break;
             }
             default:
@@ -419,6 +770,9 @@ void Pd::xfer_items (Pd *src, Crd xlt, Crd del, Xfer *s, Xfer *d, unsigned long
         if (d)
             *d-- = Xfer (crd, s->flags() | set_as_del);
     }
+
+    /* one IOMMU flush and one shootdown for the whole batch */
+    flush_deferred (flush);
 }
 
 void Pd::assign_rid(uint16 const r)
@@ -461,7 +815,7 @@ Pd::~Pd()
     if (Ipt::active())
         Space_mem::ipt.clear(quota);
 
-    Space_mem::npt.clear(quota);
+    Space_mem::npt.clear(quota, nullptr, nullptr, Quota::KIND_NPT);
 
     for (unsigned cpu = 0; cpu < NUM_CPU; cpu++)
         if (Hip::cpu_online (cpu))
@@ -0,0 +1,173 @@
+/*
+ * Performance Monitoring Unit (PMU) Sampling
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "ec.hpp"
+#include "extern.hpp"
+#include "msr.hpp"
+#include "pmu.hpp"
+#include "utcb.hpp"
+
+Pmu::Sample *   Pmu::ring;
+unsigned        Pmu::head;
+unsigned        Pmu::tail;
+unsigned        Pmu::lost;
+unsigned        Pmu::depth;
+unsigned        Pmu::version;
+uint64          Pmu::period;
+
+bool Pmu::supported()
+{
+    if (Cpu::vendor == Cpu::Vendor::AMD)
+        return true;
+
+    if (Cpu::vendor != Cpu::Vendor::INTEL)
+        return false;
+
+    uint32 eax, ebx, ecx, edx;
+
+    Cpu::cpuid (0, eax, ebx, ecx, edx);
+    if (eax < 0xa)
+        return false;
+
+    /* Architectural performance monitoring with at least one counter */
+    Cpu::cpuid (0xa, eax, ebx, ecx, edx);
+
+    version = eax & 0xff;
+
+    return version && eax >> 8 & 0xff;
+}
+
+bool Pmu::rearm()
+{
+    uint64 const v = 0 - period;
+
+    if (Cpu::vendor == Cpu::Vendor::AMD)
+        return Msr::guard_write (Msr::AMD_PERF_CTR0, v & ((1ULL << 48) - 1));
+
+    if (version >= 2 && !Msr::guard_write (Msr::IA32_PERF_GLOBAL_OVF, 1))
+        return false;
+
+    /* Bits above 31 are sign-extended from bit 31 */
+    return Msr::guard_write (Msr::IA32_PMC0, v);
+}
+
+void Pmu::stop()
+{
+    if (period)
+        Msr::guard_write (Cpu::vendor == Cpu::Vendor::AMD ? Msr::AMD_PERF_CTL0 : Msr::IA32_PERFEVTSEL0, 0);
+
+    period = 0;
+}
+
+bool Pmu::config (mword event, mword p, mword d)
+{
+    stop();
+
+    if (!event)
+        return true;
+
+    if (!p || p >= 1UL << 31 || !supported())
+        return false;
+
+    if (!ring && !(ring = static_cast<Sample *>(Buddy::allocator.alloc (0, Pd::kern.quota, Buddy::NOFILL))))
+        return false;
+
+    head = tail = lost = 0;
+    depth  = static_cast<unsigned>(min (d, mword (DEPTH)));
+    period = p;
+
+    Msr::Register const sel = Cpu::vendor == Cpu::Vendor::AMD ? Msr::AMD_PERF_CTL0 : Msr::IA32_PERFEVTSEL0;
+
+    if (!rearm())
+        return false;
+
+    if (Cpu::vendor == Cpu::Vendor::INTEL && version >= 2) {
+        uint64 ctrl;
+        if (!Msr::guard_read (Msr::IA32_PERF_GLOBAL_CTRL, ctrl) || !Msr::guard_write (Msr::IA32_PERF_GLOBAL_CTRL, ctrl | 1))
+            return false;
+    }
+
+    /* Count in the kernel only */
+    if (Msr::guard_write (sel, (event & 0xffff) | SEL_OS | SEL_INT | SEL_EN))
+        return true;
+
+    period = 0;
+
+    return false;
+}
+
+/*
+ * The kernel is built without frame pointers, so the chain consists of
+ * the innermost words on the interrupted stack that point into the
+ * kernel text.
+ */
+void Pmu::frames (Sample &s, mword sp)
+{
+    unsigned n = 0;
+
+    if (sp < CPU_LOCAL_STCK)
+        sp = CPU_LOCAL_STCK + PAGE_SIZE;
+
+    for (mword const *w = reinterpret_cast<mword const *>(sp); n < depth && reinterpret_cast<mword>(w) < CPU_LOCAL_STCK + PAGE_SIZE; w++)
+        if (*w >= LINK_ADDR && *w < reinterpret_cast<mword>(&TEXT_E))
+            s.frame[n++] = *w;
+
+    for (; n < DEPTH; n++)
+        s.frame[n] = 0;
+}
+
+void Pmu::sample (Exc_regs const *r)
+{
+    if (!period || !rearm())
+        return;
+
+    if (head - tail >= SAMPLES) {
+        lost++;
+        return;
+    }
+
+    Sample &s = ring[head % SAMPLES];
+
+    s.tsc = rdtsc();
+    s.rip = r ? r->REG(ip) : 0;
+    s.cs  = r ? r->cs : 0;
+    s.ec  = reinterpret_cast<mword>(Ec::current);
+    s.pd  = reinterpret_cast<mword>(Pd::current);
+
+#ifdef __x86_64__
+    frames (s, r && !r->user() ? r->REG(sp) : 0);
+#else
+    /* No stack switch, so the interrupted stack continues after the frame */
+    frames (s, r && !r->user() ? reinterpret_cast<mword>(&r->REG(sp)) : 0);
+#endif
+
+    head++;
+}
+
+unsigned Pmu::drain (Utcb *utcb, unsigned &l)
+{
+    mword const words = sizeof (Sample) / sizeof (mword);
+
+    unsigned n = 0;
+
+    utcb->clear_items();
+
+    for (; tail != head && utcb->store (n * words, ring + tail % SAMPLES, words); tail++, n++) ;
+
+    l = lost;
+    lost = 0;
+
+    return n;
+}
@@ -19,12 +19,15 @@
  * GNU General Public License version 2 for more details.
  */
 
+#include "atomic.hpp"
 #include "ec.hpp"
 #include "pt.hpp"
 #include "stdio.hpp"
 
 Pt::Pt (Pd *own, mword sel, Ec *e, Mtd m, mword addr) : Kobject (PT, static_cast<Space_obj *>(own), sel, PERM_CTRL | PERM_CALL | PERM_XCPU, free), ec (e), mtd (m), ip (addr), id(0)
 {
+    Atomic::add (e->pt_count, 1UL);
+
     trace (TRACE_SYSCALL, "PT:%p created (EC:%p IP:%#lx)", this, e, ip);
 }
 
@@ -36,6 +39,7 @@ void * Pt::operator new (size_t, Pd &pd)
 void Pt::destroy(Pt *obj)
 {
     Pd &pd = *obj->ec->pd;
+    Atomic::sub (obj->ec->pt_count, 1UL);
     obj->~Pt(); pd.pt_cache.free (obj, pd.quota);
 }
 
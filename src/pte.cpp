@@ -33,7 +33,7 @@ mword Ipt::ord = ~0UL;
 bool  Dpt::force_flush = false;
 
 template <typename P, typename E, unsigned L, unsigned B, bool F, bool V>
-P *Pte<P,E,L,B,F,V>::walk (Quota &quota, E v, unsigned long n, bool a)
+P *Pte<P,E,L,B,F,V>::walk (Quota &quota, E v, unsigned long n, bool a, Quota::Kind k)
 {
     unsigned long l = L;
 
@@ -47,8 +47,8 @@ P *Pte<P,E,L,B,F,V>::walk (Quota &quota, E v, unsigned long n, bool a)
             if (!a)
                 return nullptr;
 
-            if (!e->set (0, Buddy::ptr_to_phys (p = new (quota) P) | (l == L ? 0 : E(P::PTE_N)) | (V ? E(l) << 9 : 0)))
-                Pte::destroy(p, quota);
+            if (!e->set (0, Buddy::ptr_to_phys (p = new (quota, k) P) | (l == L ? 0 : E(P::PTE_N)) | (V ? E(l) << 9 : 0)))
+                Pte::destroy(p, quota, k);
         }
     }
 }
@@ -77,11 +77,36 @@ size_t Pte<P,E,L,B,F,V>::lookup (E v, Paddr &p, mword &a)
 }
 
 template <typename P, typename E, unsigned L, unsigned B, bool F, bool V>
-bool Pte<P,E,L,B,F,V>::update (Quota &quota, E v, mword o, E p, E a, Type t)
+size_t Pte<P,E,L,B,F,V>::harvest (E v, E m, bool &a)
+{
+    unsigned long l = L;
+
+    for (P *e = static_cast<P *>(this);; e = static_cast<P *>(Buddy::phys_to_ptr (e->addr())) + (v >> (--l * B + PAGE_BITS) & ((1UL << B) - 1))) {
+
+        if (EXPECT_FALSE (!e->val))
+            return 0;
+
+        if (EXPECT_FALSE (l && !e->super(l)))
+            continue;
+
+        a = false;
+
+        for (E o; (o = e->val) & m;)
+            if (e->set (o, o & ~m)) {
+                a = true;
+                break;
+            }
+
+        return 1UL << (l * B + e->order());
+    }
+}
+
+template <typename P, typename E, unsigned L, unsigned B, bool F, bool V>
+bool Pte<P,E,L,B,F,V>::update (Quota &quota, E v, mword o, E p, E a, Type t, Quota::Kind k)
 {
     unsigned long l = o / B, n = 1UL << o % B, s;
 
-    P *e = walk (quota, v, l, t == TYPE_UP);
+    P *e = walk (quota, v, l, t == TYPE_UP, k);
 
     if (!e)
         return false;
@@ -106,7 +131,7 @@ bool Pte<P,E,L,B,F,V>::update (Quota &quota, E v, mword o, E p, E a, Type t)
             continue;
 
         if (l && !e[i].super(l)) {
-            Pte::destroy(static_cast<P *>(Buddy::phys_to_ptr (e[i].addr())), quota);
+            Pte::destroy(static_cast<P *>(Buddy::phys_to_ptr (e[i].addr())), quota, k);
             flush_tlb = true;
         }
     }
@@ -118,20 +143,20 @@ bool Pte<P,E,L,B,F,V>::update (Quota &quota, E v, mword o, E p, E a, Type t)
 }
 
 template <typename P, typename E, unsigned L, unsigned B, bool F, bool V>
-void Pte<P,E,L,B,F,V>::clear (Quota &quota, bool (*d) (Paddr, mword, unsigned), bool (*il) (unsigned, mword))
+void Pte<P,E,L,B,F,V>::clear (Quota &quota, bool (*d) (Paddr, mword, unsigned), bool (*il) (unsigned, mword), Quota::Kind k)
 {
     if (!val)
         return;
 
     P * e = static_cast<P *>(Buddy::phys_to_ptr (this->addr()));
 
-    e->free_up(quota, L - 1, e, 0, d, il);
+    e->free_up(quota, L - 1, e, 0, d, il, k);
 
-    Pte::destroy (e, quota);
+    Pte::destroy (e, quota, k);
 }
 
 template <typename P, typename E, unsigned L, unsigned B, bool F, bool V>
-void Pte<P,E,L,B,F,V>::free_up (Quota &quota, unsigned l, P * e, mword v, bool (*d)(Paddr, mword, unsigned), bool (*il) (unsigned, mword))
+void Pte<P,E,L,B,F,V>::free_up (Quota &quota, unsigned l, P * e, mword v, bool (*d)(Paddr, mword, unsigned), bool (*il) (unsigned, mword), Quota::Kind k)
 {
     if (!e)
         return;
@@ -144,13 +169,46 @@ void Pte<P,E,L,B,F,V>::free_up (Quota &quota, unsigned l, P * e, mword v, bool (
         mword virt = v + (i << (l * B + PAGE_BITS));
 
         if (il ? il(l, virt) : l > 1)
-            p->free_up(quota, l - 1, p, virt, d, il);
+            p->free_up(quota, l - 1, p, virt, d, il, k);
 
         if (!d || d(e[i].addr(), virt, l))
-            Pte::destroy(p, quota);
+            Pte::destroy(p, quota, k);
     }
 }
 
+/*
+ * Number of page-table pages that clear() would return to the quota
+ */
+template <typename P, typename E, unsigned L, unsigned B, bool F, bool V>
+mword Pte<P,E,L,B,F,V>::pages (bool (*d)(Paddr, mword, unsigned), bool (*il) (unsigned, mword)) const
+{
+    if (!val)
+        return 0;
+
+    return 1 + count (L - 1, static_cast<P const *>(Buddy::phys_to_ptr (this->addr())), 0, d, il);
+}
+
+template <typename P, typename E, unsigned L, unsigned B, bool F, bool V>
+mword Pte<P,E,L,B,F,V>::count (unsigned l, P const * e, mword v, bool (*d)(Paddr, mword, unsigned), bool (*il) (unsigned, mword))
+{
+    mword n = 0;
+
+    for (unsigned long i = 0; i < (1 << B); i++) {
+        if (!e[i].val || e[i].super(l))
+            continue;
+
+        mword virt = v + (i << (l * B + PAGE_BITS));
+
+        if (il ? il(l, virt) : l > 1)
+            n += count (l - 1, static_cast<P const *>(Buddy::phys_to_ptr (e[i].addr())), virt, d, il);
+
+        if (!d || d(e[i].addr(), virt, l))
+            n++;
+    }
+
+    return n;
+}
+
 template class Pte<Dpt, uint64, 4, 9, true, false>;
 template class Pte<Ipt, uint64, 4, 9, true, true>;
 template class Pte<Ept, uint64, 4, 9, false, false>;
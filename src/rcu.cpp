@@ -26,6 +26,7 @@
 #include "initprio.hpp"
 #include "rcu.hpp"
 #include "stdio.hpp"
+#include "tracebuf.hpp"
 #include "hip.hpp"
 #include "lapic.hpp"
 #include "vectors.hpp"
@@ -80,6 +81,7 @@ void Rcu::update(bool const check)
     if (l_batch != batch()) {
         l_batch = batch();
         Cpu::hazard |= HZD_RCU;
+        Tracebuf::log (Tracebuf::EVT_RCU, l_batch);
         Counter::print<1,16> (l_batch, Console_vga::COLOR_LIGHT_GREEN, SPN_RCU);
     }
 
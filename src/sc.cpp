@@ -35,6 +35,8 @@ unsigned    Sc::ctr_loop;
 uint64      Sc::long_loop;
 uint64      Sc::cross_time[NUM_CPU];
 uint64      Sc::killed_time[NUM_CPU];
+uint64      Sc::wait_time;
+uint64      Sc::wait_count;
 
 Sc *Sc::list[Sc::priorities];
 
@@ -91,6 +93,10 @@ void Sc::ready_enqueue (uint64 t, bool inc_ref, bool use_left)
     if (!left)
         left = budget;
 
+    /* A preempted SC is not woken up */
+    if (this != current && !wake)
+        wake = t;
+
     tsc = t;
 }
 
@@ -112,6 +118,23 @@ void Sc::ready_dequeue (uint64 t)
 
     trace (TRACE_SCHEDULE, "DEQ:%p (%llu) PRIO:%#x TOP:%#x", this, left, prio, prio_top);
 
+    /* Skip the idle SC */
+    if (prio) {
+        wait_time += t - tsc;
+        wait_count++;
+
+        if (wake) {
+            uint64 const l = t > wake ? t - wake : 0;
+
+            latency.add (l);
+
+            if (l > latency_max)
+                latency_max = l;
+
+            wake = 0;
+        }
+    }
+
     ec->add_tsc_offset (tsc - t);
 
     tsc = t;
@@ -173,6 +196,9 @@ void Sc::remote_enqueue(bool inc_ref)
 
         Lock_guard <Spinlock> guard (r->lock);
 
+        /* The wake-up latency includes the remote enqueue */
+        wake = rdtsc();
+
         if (r->queue) {
             next = r->queue;
             prev = r->queue->prev;
@@ -21,7 +21,7 @@
 
 #include "stdio.hpp"
 
-static Spinlock lock;
+static Spinlock lock { Spinlock::LOCK_SI };
 
 Si::Si (Sm * s, mword v) : sm(s), prev(nullptr), next(nullptr), value(v)
 {
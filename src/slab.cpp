@@ -67,7 +67,8 @@ Slab_cache::Slab_cache (unsigned long elem_size, unsigned elem_align)
             head (nullptr),
             size (align_up (elem_size, sizeof (mword))),
             buff (align_up (size + sizeof (mword), elem_align)),
-            elem ((PAGE_SIZE - sizeof (Slab)) / buff)
+            elem ((PAGE_SIZE - sizeof (Slab)) / buff),
+            pages (0)
 {
     trace (TRACE_MEMORY, "Slab Cache:%p (S:%lu A:%u)",
            this,
@@ -84,6 +85,8 @@ void Slab_cache::grow(Quota &quota)
 
     slab->next = head;
     head = curr = slab;
+
+    pages++;
 }
 
 void *Slab_cache::alloc(Quota &quota)
@@ -162,6 +165,7 @@ void Slab_cache::free (void *ptr, Quota &quota)
                 // There are already empty slabs - delete current slab
                 assert(head != slab);
                 Slab::destroy (slab, quota);
+                pages--;
             } else {
                 // There are partial slabs in front of us - requeue empty one
                 // Enqueue as head
@@ -181,6 +185,7 @@ void Slab_cache::free (Quota &quota)
         curr = head;
         Slab::destroy(head, quota);
         head = curr->next;
+        pages--;
     }
     assert (!head);
     curr = nullptr;
@@ -21,7 +21,80 @@
 #include "sm.hpp"
 #include "stdio.hpp"
 
-Sm::Sm (Pd *own, mword sel, mword cnt, Sm * s, mword v) : Kobject (SM, static_cast<Space_obj *>(own), sel, 0x3, free), Si (s, v), counter (cnt)
+Sm::Sm (Pd *own, mword sel, mword cnt, Sm * s, mword v) : Kobject (SM, static_cast<Space_obj *>(own), sel, 0x3, free, pre_free), Si (s, v), counter (cnt)
 {
     trace (TRACE_SYSCALL, "SM:%p created (CNT:%lu)", this, cnt);
 }
+
+bool Sm::chan_setup (Pd *pd, mword addr)
+{
+    if (!pd->add_ref())
+        return false;
+
+    auto ring = static_cast<Chan_ring *>(Buddy::allocator.alloc (0, pd->quota, Buddy::FILL_0));
+    if (!ring) {
+        if (pd->del_rcu())
+            Rcu::call (pd);
+        return false;
+    }
+
+    mword const phys = Buddy::ptr_to_phys (ring);
+
+    if (!pd->insert_utcb (pd->quota, pd->mdb_cache, addr, phys >> PAGE_BITS)) {
+        Buddy::allocator.free (reinterpret_cast<mword>(ring), pd->quota);
+        if (pd->del_rcu())
+            Rcu::call (pd);
+        return false;
+    }
+
+    pd->Space_mem::insert (pd->quota, addr, 0, Hpt::HPT_NX | Hpt::HPT_U | Hpt::HPT_W | Hpt::HPT_P, phys);
+
+    chan_pd   = pd;
+    chan_addr = addr;
+    chan_ring = ring;
+
+    trace (TRACE_SYSCALL, "SM:%p channel (PD:%p RING:%#lx)", this, pd, addr);
+
+    return true;
+}
+
+/*
+ * Unmap the ring from the owner and every PD it was delegated to, unless
+ * the owner replaced the mapping meanwhile, which revoked the ring already.
+ * Only the first caller unmaps, the SM may be retired more than once.
+ */
+void Sm::chan_unmap()
+{
+    mword const addr = chan_addr;
+
+    if (!addr || !Atomic::cmp_swap (chan_addr, addr, 0UL))
+        return;
+
+    mword const page = addr >> PAGE_BITS, phys = Buddy::ptr_to_phys (chan_ring) >> PAGE_BITS;
+
+    Mdb *mdb = chan_pd->Space_mem::tree_lookup (page);
+    if (!mdb || mdb->node_phys + page - mdb->node_base != phys)
+        return;
+
+    chan_pd->revoke<Space_mem> (page, 0, 0x1f, true, false);
+    chan_pd->Space_mem::insert (chan_pd->quota, addr, 0, 0, 0);
+
+    Space_mem::shootdown (chan_pd);
+}
+
+/*
+ * The ring is unmapped by pre_free, so it is not reachable any more once
+ * the SM is destroyed after the grace period. An SM destroyed directly
+ * was never published and is unmapped here.
+ */
+void Sm::chan_free()
+{
+    chan_unmap();
+
+    Buddy::allocator.free (reinterpret_cast<mword>(chan_ring), chan_pd->quota);
+
+    if (chan_pd->del_rcu())
+        Rcu::call (chan_pd);
+
+    chan_ring = nullptr;
+}
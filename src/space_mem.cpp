@@ -27,6 +27,7 @@
 #include "pd.hpp"
 #include "stdio.hpp"
 #include "svm.hpp"
+#include "tracebuf.hpp"
 #include "vectors.hpp"
 
 Bit_alloc<4096, Space_mem::NO_PCID> Space_mem::did_alloc;
@@ -53,6 +54,10 @@ bool Space_mem::update (Quota_guard &quota, Mdb *mdb, mword r)
     mword a = mdb->node_attr & ~r;
     mword s = mdb->node_sub;
 
+    /* mapped read-only and with leaf entries only, so that a write fault can split the node in place */
+    if (s & SUB_COW)
+        a &= ~0x2UL;
+
     bool f = false;
 
     if (s & 1 && Dpt::active()) {
@@ -84,17 +89,17 @@ bool Space_mem::update (Quota_guard &quota, Mdb *mdb, mword r)
 
     if (s & 2) {
         if (Vmcb::has_npt()) {
-            mword ord = min (o, Hpt::ord);
+            mword ord = min (o, s & SUB_COW ? min (Hpt::ord, Hpt::bpl() - 1UL) : Hpt::ord);
             for (unsigned long i = 0; i < 1UL << (o - ord); i++) {
                 if (!r && !npt.check(quota, ord)) {
                     Cpu::hazard |= HZD_OOM;
                     return false;
                 }
 
-                npt.update (quota, b + i * (1UL << (ord + PAGE_BITS)), ord, p + i * (1UL << (ord + PAGE_BITS)), Hpt::hw_attr (a), r ? Hpt::TYPE_DN : Hpt::TYPE_UP);
+                npt.update (quota, b + i * (1UL << (ord + PAGE_BITS)), ord, p + i * (1UL << (ord + PAGE_BITS)), Hpt::hw_attr (a), r ? Hpt::TYPE_DN : Hpt::TYPE_UP, Quota::KIND_NPT);
             }
         } else {
-            mword ord = min (o, Ept::ord);
+            mword ord = min (o, s & SUB_COW ? min (Ept::ord, Ept::bpl() - 1UL) : Ept::ord);
             for (unsigned long i = 0; i < 1UL << (o - ord); i++) {
                 if (!r && !ept.check(quota, ord)) {
                     Cpu::hazard |= HZD_OOM;
@@ -119,7 +124,7 @@ bool Space_mem::update (Quota_guard &quota, Mdb *mdb, mword r)
         (mdb->node_base + (1UL << o) <= mdb->node_base))
         return false;
 
-    mword ord = min (o, Hpt::ord);
+    mword ord = min (o, s & SUB_COW ? min (Hpt::ord, Hpt::bpl() - 1UL) : Hpt::ord);
 
     for (unsigned long i = 0; i < 1UL << (o - ord); i++) {
         if (!r && !hpt.check(quota, ord)) {
@@ -154,6 +159,8 @@ bool Space_mem::update (Quota_guard &quota, Mdb *mdb, mword r)
 
 void Space_mem::shootdown(Pd * local)
 {
+    unsigned ipis = 0;
+
     for (unsigned cpu = 0; cpu < NUM_CPU; cpu++) {
 
         if (!Hip::cpu_online (cpu))
@@ -172,9 +179,10 @@ void Space_mem::shootdown(Pd * local)
             continue;
         }
 
-        unsigned ctr = Counter::remote (cpu, 1);
+        mword ctr = Counter::remote (cpu, 1);
 
         Lapic::send_ipi (cpu, VEC_IPI_RKE);
+        ipis++;
 
         if (!Cpu::preemption)
             asm volatile ("sti" : : : "memory");
@@ -188,6 +196,8 @@ void Space_mem::shootdown(Pd * local)
         if (!sent)
             trace (0, "IPI timeout cpu %u->%u", Cpu::id, cpu);
     }
+
+    Tracebuf::log (Tracebuf::EVT_SHOOTDOWN, reinterpret_cast<mword>(local), ipis);
 }
 
 void Space_mem::insert_root (Quota &quota, Slab_cache &cache, uint64 s, uint64 e, mword a)
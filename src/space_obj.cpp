@@ -33,10 +33,10 @@ Paddr Space_obj::walk (Quota &quota, mword idx, bool &shootdown)
 
         shootdown = (phys & ~PAGE_MASK) == reinterpret_cast<Paddr>(&FRAME_0);
 
-        Paddr p = Buddy::ptr_to_phys (ptr = Buddy::allocator.alloc (0, quota, Buddy::FILL_0));
+        Paddr p = Buddy::ptr_to_phys (ptr = Buddy::allocator.alloc (0, quota, Buddy::FILL_0, Hpt::KIND));
 
         if ((phys = space_mem()->replace (quota, virt, p | Hpt::HPT_NX | Hpt::HPT_D | Hpt::HPT_A | Hpt::HPT_W | Hpt::HPT_P)) != p)
-            Buddy::allocator.free (reinterpret_cast<mword>(ptr), quota);
+            Buddy::allocator.free (reinterpret_cast<mword>(ptr), quota, Hpt::KIND);
 
         phys |= virt & PAGE_MASK;
     }
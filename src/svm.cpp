@@ -59,13 +59,13 @@ struct Msr_bitmap
     static inline void *operator new (size_t, Quota &quota)
     {
         /* allocate two pages and set all bits */
-        return Buddy::allocator.alloc(1, quota, Buddy::FILL_1);
+        return Buddy::allocator.alloc(1, quota, Buddy::FILL_1, Quota::KIND_VCPU);
     }
 
     ALWAYS_INLINE
     static inline void destroy(Msr_bitmap *obj, Quota &quota)
     {
-        Buddy::allocator.free(reinterpret_cast<mword>(obj), quota);
+        Buddy::allocator.free(reinterpret_cast<mword>(obj), quota, Quota::KIND_VCPU);
     }
 };
 
@@ -97,7 +97,7 @@ void Vmcb::destroy(Vmcb &obj, Quota &quota)
 
     obj.~Vmcb();
 
-    Buddy::allocator.free (reinterpret_cast<mword>(&obj), quota);
+    Buddy::allocator.free (reinterpret_cast<mword>(&obj), quota, Quota::KIND_VCPU);
 }
 
 void Vmcb::init()
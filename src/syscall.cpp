@@ -26,6 +26,7 @@
 #include "hpet.hpp"
 #include "lapic.hpp"
 #include "pci.hpp"
+#include "pmu.hpp"
 #include "pt.hpp"
 #include "sm.hpp"
 #include "stdio.hpp"
@@ -75,7 +76,7 @@ void Ec::delegate()
     Ec *src = C ? ec : current;
     Ec *dst = C ? current : ec;
 
-    bool user = C || ((dst->cont == ret_user_sysexit) || (dst->cont == xcpu_return));
+    bool user = C || ((dst->cont == ret_user_sysexit) || (dst->cont == xcpu_return) || (dst->cont == ret_call_vec) || (dst->cont == ret_call_async));
 
     dst->pd->xfer_items (src->pd,
                          user ? dst->utcb->xlt : Crd (0),
@@ -109,6 +110,9 @@ void Ec::send_msg()
         die ("PT wrong CPU");
 
     if (EXPECT_TRUE (!ec->cont)) {
+        if (EXPECT_FALSE (current->vmstat))
+            current->vmstat->delivered();
+
         current->cont = C;
         current->set_partner (ec);
         current->regs.mtd = pt->mtd.val;
@@ -154,9 +158,19 @@ void Ec::sys_call()
     if (EXPECT_TRUE (!ec->cont)) {
         current->cont = current->xcpu_sm ? xcpu_return : ret_user_sysexit;
         current->set_partner (ec);
-        ec->cont = recv_user;
         ec->regs.set_pt (pt->id);
         ec->regs.set_ip (pt->ip);
+
+        // Register-only message, bypasses the UTCB and typed items
+        if (s->flags() & Sys_call::REGISTER_MSG) {
+            current->regs.set_status (Sys_regs::SUCCESS, false);
+            ec->regs.copy_msg (current->regs);
+            ec->cont = ret_user_sysexit;
+        } else
+            ec->cont = recv_user;
+
+        Tracebuf::log (Tracebuf::EVT_CALL, reinterpret_cast<mword>(ec), pt->id);
+
         ec->make_current();
     }
 
@@ -198,6 +212,17 @@ void Ec::recv_user()
     ret_user_sysexit();
 }
 
+void Ec::recv_vec()
+{
+    Ec *ec = current->rcap;
+
+    Sys_misc *s = static_cast<Sys_misc *>(ec->sys_regs());
+
+    ec->utcb->load_vec (current->utcb, s->vec_done(), s->vec_cnt());
+
+    ret_user_sysexit();
+}
+
 void Ec::reply (void (*c)(), Sm * sm)
 {
     current->cont = c;
@@ -221,6 +246,8 @@ void Ec::reply (void (*c)(), Sm * sm)
     if (!clr)
         Sc::current->ec->activate();
 
+    Tracebuf::log (Tracebuf::EVT_REPLY, reinterpret_cast<mword>(ec));
+
     ec->make_current();
 }
 
@@ -321,7 +348,9 @@ void Ec::sys_reply()
         if (EXPECT_FALSE (sm)) {
             if (ec->cont == ret_user_sysexit)
                 ec->cont = sys_call;
-            else if (ec->cont == xcpu_return)
+            else if (ec->cont == ret_call_vec)
+                ec->cont = call_vec;
+            else if (ec->cont == xcpu_return || ec->cont == ret_call_async)
                 ec->regs.set_status (Sys_regs::BAD_HYP, false);
             else if (ec->cont == sys_reply) {
                 assert (ec->regs.status() == SYSCALL_REPLY);
@@ -331,6 +360,12 @@ void Ec::sys_reply()
             }
         }
 
+        if (EXPECT_TRUE (!sm && (r->flags() & Sys_reply::REGISTER_MSG) &&
+                         ((ec->cont == ret_user_sysexit) || ec->cont == xcpu_return))) {
+            ec->regs.copy_msg (current->regs);
+            reply();
+        }
+
         Utcb *src = current->utcb;
 
         if (EXPECT_FALSE (src->tcnt()))
@@ -340,8 +375,12 @@ void Ec::sys_reply()
 
         assert (current->cont != ret_xcpu_reply);
 
-        if (EXPECT_TRUE ((ec->cont == ret_user_sysexit) || ec->cont == xcpu_return))
+        if (EXPECT_TRUE ((ec->cont == ret_user_sysexit) || ec->cont == xcpu_return || ec->cont == ret_call_async))
             src->save (ec->utcb);
+        else if (ec->cont == ret_call_vec) {
+            Sys_misc *s = static_cast<Sys_misc *>(ec->sys_regs());
+            src->save_vec (ec->utcb, s->vec_done(), s->vec_cnt());
+        }
         else if (ec->cont == ret_user_iret)
             fpu = src->save_exc (&ec->regs);
         else if (ec->cont == ret_user_vmresume)
@@ -585,14 +624,27 @@ void Ec::sys_create_sm()
     }
     Pd *pd = static_cast<Pd *>(cap.obj());
 
-    if (pd->quota.hit_limit(1)) {
+    if (pd->quota.hit_limit(r->chan() ? 4 : 1)) {
         trace(TRACE_OOM, "%s:%u - not enough resources %lu/%lu", __func__, __LINE__, pd->quota.usage(), pd->quota.limit());
         sys_finish<Sys_regs::QUO_OOM>();
     }
 
+    if (EXPECT_FALSE (r->chan() && (r->sm() || (r->chan_addr() & PAGE_MASK) || r->chan_addr() >= USER_ADDR))) {
+        trace (TRACE_ERROR, "%s: Bad channel (%#lx)", __func__, r->chan_addr());
+        sys_finish<Sys_regs::BAD_PAR>();
+    }
+
     Sm * sm;
 
-    if (r->sm()) {
+    if (r->chan()) {
+        sm = new (*Pd::current) Sm (Pd::current, r->sel(), 0);
+
+        if (!sm->chan_setup (pd, r->chan_addr())) {
+            trace (TRACE_ERROR, "%s: Channel setup failed (%#lx)", __func__, r->chan_addr());
+            Sm::destroy(sm, *Pd::current);
+            sys_finish<Sys_regs::BAD_PAR>();
+        }
+    } else if (r->sm()) {
         /* check for valid SM to be chained with */
         Capability cap_si = Space_obj::lookup (r->sm());
         if (EXPECT_FALSE (cap_si.obj()->type() != Kobject::SM)) {
@@ -642,10 +694,13 @@ void Ec::sys_revoke()
         current->cont = sys_revoke;
 
         r->rem(pd);
+        current->rev_next = r->crd().base();
     } else
         pd = reinterpret_cast<Pd *>(r->pd());
 
-    pd->rev_crd (r->crd(), r->self(), true, r->keep());
+    /* yield with the progress recorded in the EC and continue from there */
+    if (!pd->rev_crd (r->crd(), r->self(), true, r->keep(), &current->rev_next))
+        Sc::schedule();
 
     current->cont = sys_finish<Sys_regs::SUCCESS>;
     r->rem(nullptr);
@@ -732,11 +787,160 @@ void Ec::sys_misc()
 
         sys_finish<Sys_regs::SUCCESS>();
     }
+    case Sys_misc::SYS_CALL_VEC: {
+        trace (TRACE_SYSCALL, "EC:%p SYS_CALL_VEC CNT:%lu", current, s->vec_cnt());
+
+        s->vec_done() = 0;
+
+        call_vec();
+    }
+    case Sys_misc::SYS_CALL_ASYNC: {
+        trace (TRACE_SYSCALL, "EC:%p SYS_CALL_ASYNC EC:%#lx PT:%#lx SM:%#lx", current, s->async_ec(), s->async_pt(), s->async_sm());
+
+        Capability cap_ec = Space_obj::lookup (s->async_ec());
+        Capability cap_pt = Space_obj::lookup (s->async_pt());
+        Capability cap_sm = Space_obj::lookup (s->async_sm());
+
+        if (EXPECT_FALSE (cap_ec.obj()->type() != Kobject::EC || cap_pt.obj()->type() != Kobject::PT ||
+                          cap_sm.obj()->type() != Kobject::SM || !(cap_sm.prm() & 1))) {
+            trace (TRACE_ERROR, "%s: Bad CAP", __func__);
+            sys_finish<Sys_regs::BAD_CAP>();
+        }
+
+        Ec *ec = static_cast<Ec *>(cap_ec.obj());
+        Sm *sm = static_cast<Sm *>(cap_sm.obj());
+
+        /* an idle local EC of the caller's PD that no portal is bound to carries the call */
+        if (EXPECT_FALSE (ec->pd != Pd::current || ec->glb || ec->cont || ec->pt_count || !ec->utcb || ec->cpu != current->cpu))
+            sys_finish<Sys_regs::BAD_PAR>();
+
+        if (EXPECT_FALSE (!sm->add_ref()))
+            sys_finish<Sys_regs::BAD_CAP>();
+
+        Sc *sc = new (*Pd::current) Sc (Pd::current, 0, ec, ec->cpu, Sc::current->prio, static_cast<unsigned>(Sc::current->budget / (Lapic::freq_tsc / 1000)));
+
+        ec->async_sm = sm;
+        ec->cont     = call_async;
+        ec->regs.set_pt (s->async_pt() << 8);
+
+        sc->remote_enqueue (false);
+
+        sys_finish<Sys_regs::SUCCESS>();
+    }
     default:
         sys_finish<Sys_regs::BAD_PAR>();
     }
 }
 
+/*
+ * Issue the calls of a vectored portal call one after another. The
+ * index of the current call is kept in the caller's registers, which
+ * also tells user space how far a failed vector got.
+ */
+void Ec::call_vec()
+{
+    Sys_misc *s = static_cast<Sys_misc *>(current->sys_regs());
+
+    if (s->vec_done() >= s->vec_cnt())
+        sys_finish<Sys_regs::SUCCESS>();
+
+    if (EXPECT_FALSE (!current->utcb->vec_valid (s->vec_done(), s->vec_cnt())))
+        sys_finish<Sys_regs::BAD_PAR>();
+
+    Kobject *obj = Space_obj::lookup (current->utcb->vec (s->vec_done()).pt()).obj();
+    if (EXPECT_FALSE (obj->type() != Kobject::PT))
+        sys_finish<Sys_regs::BAD_CAP>();
+
+    Pt *pt = static_cast<Pt *>(obj);
+    Ec *ec = pt->ec;
+
+    if (EXPECT_FALSE (current->cpu != ec->xcpu))
+        sys_finish<Sys_regs::BAD_CPU>();
+
+    if (EXPECT_TRUE (!ec->cont)) {
+        current->cont = ret_call_vec;
+        current->set_partner (ec);
+        ec->cont = recv_vec;
+        ec->regs.set_pt (pt->id);
+        ec->regs.set_ip (pt->ip);
+        ec->make_current();
+    }
+
+    ec->help (call_vec);
+
+    sys_finish<Sys_regs::COM_TIM>();
+}
+
+void Ec::ret_call_vec()
+{
+    static_cast<Sys_misc *>(current->sys_regs())->vec_done()++;
+
+    call_vec();
+}
+
+/*
+ * Executed by the EC carrying an asynchronous call, on a one-shot SC
+ * derived from the submitter's SC.
+ */
+void Ec::call_async()
+{
+    Sys_call *s = static_cast<Sys_call *>(current->sys_regs());
+
+    Kobject *obj = Space_obj::lookup (s->pt()).obj();
+    if (EXPECT_FALSE (obj->type() != Kobject::PT)) {
+        current->regs.set_status (Sys_regs::BAD_CAP);
+        ret_call_async();
+    }
+
+    Pt *pt = static_cast<Pt *>(obj);
+    Ec *ec = pt->ec;
+
+    if (EXPECT_FALSE (current->cpu != ec->xcpu)) {
+        current->regs.set_status (Sys_regs::BAD_CPU);
+        ret_call_async();
+    }
+
+    if (EXPECT_TRUE (!ec->cont)) {
+        current->cont = ret_call_async;
+        current->set_partner (ec);
+        ec->cont = recv_user;
+        ec->regs.set_pt (pt->id);
+        ec->regs.set_ip (pt->ip);
+        ec->make_current();
+    }
+
+    ec->help (call_async);
+
+    current->regs.set_status (Sys_regs::COM_ABT);
+    ret_call_async();
+}
+
+void Ec::ret_call_async()
+{
+    if (Sm *sm = current->async_sm) {
+        current->async_sm = nullptr;
+
+        /* a failed call completes with an empty reply */
+        if (current->regs.status() != Sys_regs::SUCCESS)
+            current->utcb->clear_items();
+
+        sm->submit();
+
+        if (sm->del_rcu())
+            Rcu::call (sm);
+    }
+
+    /* resumed on a helping SC, retire the own SC once it runs again */
+    if (EXPECT_FALSE (Sc::current->ec != current)) {
+        current->cont = ret_call_async;
+        Sc::current->ec->activate();
+    }
+
+    current->cont = nullptr;
+
+    Sc::schedule (true);
+}
+
 void Ec::sys_ec_ctrl()
 {
     check<sys_ec_ctrl>(1);
@@ -963,6 +1167,72 @@ void Ec::sys_ec_ctrl()
             break;
         }
 
+        case 9: /* configure PMU sampling on the current CPU */
+        case 10: /* drain PMU samples of the current CPU */
+        {
+            if (!current->utcb)
+                sys_finish<Sys_regs::BAD_PAR>();
+
+            Capability cap = Space_obj::lookup (r->ec());
+            if (!Msr::msr_cap || cap.obj() != Msr::msr_cap)
+                sys_finish<Sys_regs::BAD_CAP>();
+
+            if (r->op() == 10) {
+                unsigned lost;
+                unsigned n = Pmu::drain (current->utcb, lost);
+                r->set_drained (n, lost);
+                break;
+            }
+
+            if (!Pmu::config (r->pmu_event(), r->pmu_period(), r->pmu_depth()))
+                sys_finish<Sys_regs::BAD_FTR>();
+
+            break;
+        }
+
+        case 11: /* vCPU exit statistics */
+        {
+            Capability cap = Space_obj::lookup (r->ec());
+            if (EXPECT_FALSE (cap.obj()->type() != Kobject::EC || !(cap.prm() & 1UL << 0))) {
+                trace (TRACE_ERROR, "%s: Bad EC CAP (%#lx)", __func__, r->ec());
+                sys_finish<Sys_regs::BAD_CAP>();
+            }
+
+            Ec *ec = static_cast<Ec *>(cap.obj());
+
+            if (EXPECT_FALSE (!ec->vcpu())) {
+                trace (TRACE_ERROR, "%s: Bad EC CAP (%#lx)", __func__, r->ec());
+                sys_finish<Sys_regs::BAD_CAP>();
+            }
+
+            mword const reason = r->exit_reason();
+
+            /* An invalid exit reason enables or resets the statistics */
+            if (reason >= NUM_VMI) {
+                if (ec->vmstat) {
+                    ec->vmstat->reset();
+                    break;
+                }
+
+                Vmstat *v = new (ec->pd->quota) Vmstat;
+                if (!v)
+                    sys_finish<Sys_regs::QUO_OOM>();
+
+                if (!Atomic::cmp_swap (ec->vmstat, static_cast<Vmstat *>(nullptr), v))
+                    Vmstat::destroy (v, ec->pd->quota);
+
+                break;
+            }
+
+            if (EXPECT_FALSE (!ec->vmstat || !current->utcb))
+                sys_finish<Sys_regs::BAD_PAR>();
+
+            current->utcb->clear_items();
+            current->utcb->store (0, &ec->vmstat->histogram (reason), sizeof (Vmstat::Hist) / sizeof (mword));
+
+            break;
+        }
+
         default:
             sys_finish<Sys_regs::BAD_PAR>();
     }
@@ -984,6 +1254,28 @@ void Ec::sys_sc_ctrl()
 
     Sc *sc = static_cast<Sc *>(cap.obj());
 
+    /*
+     * Scheduling statistics in cycles: the run-queue wait of the CPU for
+     * the idle SC, otherwise the wake-up latency of the SC with its
+     * histogram in the UTCB.
+     */
+    if (EXPECT_FALSE (r->stat())) {
+        if (sc->space == static_cast<Space_obj *>(&Pd::kern)) {
+            r->set_time (Sc::remote (Sc::wait_time, sc->cpu), Sc::remote (Sc::wait_count, sc->cpu));
+            sys_finish<Sys_regs::SUCCESS>();
+        }
+
+        if (EXPECT_FALSE (!current->utcb))
+            sys_finish<Sys_regs::BAD_PAR>();
+
+        current->utcb->clear_items();
+        current->utcb->store (0, &sc->latency, sizeof (sc->latency) / sizeof (mword));
+
+        r->set_time (sc->latency_max);
+
+        sys_finish<Sys_regs::SUCCESS>();
+    }
+
     uint64 sc_time = sc->time;
     uint64 ec_time = 0;
 
@@ -1062,6 +1354,9 @@ void Ec::sys_sm_ctrl()
     switch (r->op()) {
 
         case 0:
+            if (sm->channel() && !sm->doorbell())
+                break;
+
             sm->submit();
             break;
 
@@ -1101,6 +1396,32 @@ void Ec::sys_pd_ctrl()
         sys_finish<Sys_regs::SUCCESS>();
     }
 
+    if (r->kmem()) {
+        if (EXPECT_FALSE (!current->utcb))
+            sys_finish<Sys_regs::BAD_PAR>();
+
+        mword k[Pd::KMEM_MAX];
+        src->kmem (k);
+
+        current->utcb->clear_items();
+        current->utcb->store (0, k, Pd::KMEM_MAX);
+
+        r->dump(src->quota.limit(), src->quota.usage());
+        sys_finish<Sys_regs::SUCCESS>();
+    }
+
+    if (r->harvest()) {
+        if (EXPECT_FALSE (!current->utcb))
+            sys_finish<Sys_regs::BAD_PAR>();
+
+        mword n = src->harvest (r->harvest_addr(), min (r->harvest_pages(), Utcb::bitmap_size()), r->harvest_guest(), current->utcb);
+        if (n == ~0UL)
+            sys_finish<Sys_regs::BAD_FTR>();
+
+        r->harvested (n);
+        sys_finish<Sys_regs::SUCCESS>();
+    }
+
     Capability cap_pd = Space_obj::lookup (r->dst());
     if (EXPECT_FALSE (cap_pd.obj()->type() != Kobject::PD)) {
         trace (TRACE_ERROR, "%s: Bad dst PD CAP (%#lx)", __func__, r->dst());
@@ -1108,6 +1429,17 @@ void Ec::sys_pd_ctrl()
     }
     Pd *dst = static_cast<Pd *>(cap_pd.obj());
 
+    if (r->merge()) {
+        switch (dst->merge_page (src, r->src_page(), r->dst_page())) {
+            case Pd::MERGE_BAD:  sys_finish<Sys_regs::BAD_PAR>();
+            case Pd::MERGE_OOM:  sys_finish<Sys_regs::QUO_OOM>();
+            case Pd::MERGE_DIFF: r->merged (false); break;
+            case Pd::MERGE_DONE: r->merged (true);  break;
+        }
+
+        sys_finish<Sys_regs::SUCCESS>();
+    }
+
     if (!src->quota.transfer_to(dst->quota, r->tra())) {
         trace (TRACE_ERROR, "%s: PD %p has insufficient kernel memory quota", __func__, src);
         sys_finish<Sys_regs::BAD_PAR>();
@@ -1247,45 +1579,57 @@ void Ec::sys_xcpu_call()
 
     enum { UNUSED = 0, CNT = 0 };
 
-    if (!current->sc_xcpu) {
-        current->xcpu_sm = new (*Pd::current) Sm (Pd::current, UNUSED, CNT);
-        current->ec_xcpu = new (*Pd::current) Ec (Pd::current, Pd::current, Ec::sys_call, ec->cpu, current);
+    if (!current->sm_xcpu)
+        current->sm_xcpu = new (*Pd::current) Sm (Pd::current, UNUSED, CNT);
 
-        if (!current->ec_xcpu->rcap) {
-            trace (0, "xCPU construction failure");
+    Xcpu_proxy *proxy = current->xcpu_proxy_select (ec->cpu);
 
-            Ec::destroy(current->ec_xcpu, *Pd::current);
-            Sm::destroy(current->xcpu_sm, *Pd::current);
+    if (EXPECT_FALSE (!proxy)) {
+        proxy = &current->xcpu_proxy[0];
 
-            current->ec_xcpu = nullptr;
-            current->xcpu_sm = nullptr;
+        bool sc_unused = Lapic::pause_loop_until(1, [&] {
+            return proxy->state() == Xcpu_proxy::BUSY; });
 
-            sys_finish<Sys_regs::BAD_PAR>();
+        if (!sc_unused) {
+            trace (0, "xCPU EC still in use");
+            sys_finish<Sys_regs::COM_TIM>();
         }
+    }
 
-        current->sc_xcpu = new (*Pd::current) Sc (Pd::current, current->ec_xcpu, current->ec_xcpu->cpu, Sc::current);
+    /*
+     * The caller blocks on the SM for every call, so each earlier proxy
+     * already did its Sm::up. One may still be leaving it on its CPU, but
+     * it holds the SM lock until then, which the reset takes as well.
+     */
+    current->sm_xcpu->reset (true);
+    current->xcpu_sm = current->sm_xcpu;
 
-        current->sc_xcpu->add_ref();
+    if (proxy->state() == Xcpu_proxy::NONE) {
+        proxy->ec = new (*Pd::current) Ec (Pd::current, Pd::current, Ec::sys_call, ec->cpu, current);
 
-    } else {
-        bool sc_unused = Lapic::pause_loop_until(1, [&] {
-            return !current->sc_xcpu->last_ref(); });
+        if (!proxy->ec->rcap) {
+            trace (0, "xCPU construction failure");
 
-        if (!sc_unused) {
-            trace (0, "xCPU EC still in use");
-            sys_finish<Sys_regs::COM_TIM>();
+            Ec::destroy(proxy->ec, *Pd::current);
+
+            proxy->ec        = nullptr;
+            current->xcpu_sm = nullptr;
+
+            sys_finish<Sys_regs::BAD_PAR>();
         }
 
-        current->xcpu_sm = new (*Pd::current) Sm (Pd::current, UNUSED, CNT);
-        current->ec_xcpu->xcpu_clone(*current, ec->cpu);
-        current->sc_xcpu->xcpu_clone(*Sc::current, ec->cpu);
+        proxy->sc = new (*Pd::current) Sc (Pd::current, proxy->ec, proxy->ec->cpu, Sc::current);
 
-        current->sc_xcpu->add_ref();
+    } else {
+        proxy->ec->xcpu_clone(*current, ec->cpu);
+        proxy->sc->xcpu_clone(*Sc::current, ec->cpu);
     }
 
+    proxy->sc->add_ref();
+
     current->cont = ret_xcpu_reply;
 
-    current->sc_xcpu->remote_enqueue();
+    proxy->sc->remote_enqueue();
 
     current->xcpu_sm->dn (false, 0);
 
@@ -1294,10 +1638,8 @@ void Ec::sys_xcpu_call()
 
 void Ec::ret_xcpu_reply()
 {
-    if (current->xcpu_sm) {
-        Rcu::call(current->xcpu_sm);
-        current->xcpu_sm = nullptr;
-    }
+    /* the SM stays with the caller for the next cross-CPU call */
+    current->xcpu_sm = nullptr;
 
     if (current->regs.status() != Sys_regs::SUCCESS) {
         current->cont = sys_call;
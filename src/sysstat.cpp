@@ -0,0 +1,26 @@
+/*
+ * System-Call Statistics
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "sysstat.hpp"
+
+Sysstat::Stat   Sysstat::stats[SYSCALLS];
+uint64          Sysstat::start;
+mword           Sysstat::number;
+
+void Sysstat::entered (mword n)
+{
+    start  = rdtsc();
+    number = n;
+}
@@ -0,0 +1,56 @@
+/*
+ * Trace Buffer
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "bits.hpp"
+#include "cmdline.hpp"
+#include "pd.hpp"
+#include "stdio.hpp"
+#include "tracebuf.hpp"
+
+Tracebuf::Header *  Tracebuf::base;
+Paddr               Tracebuf::phys;
+size_t              Tracebuf::size;
+
+void Tracebuf::init()
+{
+    if (!Cmdline::tracebuf || !Cpu::online)
+        return;
+
+    unsigned short const ord = static_cast<unsigned short>(ORD + (Cpu::online > 1 ? bit_scan_reverse (Cpu::online - 1) + 1 : 0));
+
+    Header *h = static_cast<Header *>(Buddy::allocator.alloc (ord, Pd::kern.quota, Buddy::FILL_0));
+    if (!h) {
+        trace (0, "TRACE: no memory for %u CPUs", Cpu::online);
+        return;
+    }
+
+    for (unsigned i = 0; i < Cpu::online; i++) {
+        Header *c = reinterpret_cast<Header *>(reinterpret_cast<mword>(h) + i * (PAGE_SIZE << ORD));
+        c->records = RECORDS;
+        c->size    = sizeof (Record);
+    }
+
+    phys = Buddy::ptr_to_phys (h);
+    size = PAGE_SIZE << ord;
+
+    /* Let the root PD map the rings read-only */
+    Pd::kern.Space_mem::insert_root (Pd::kern.quota, Pd::kern.mdb_cache, phys, phys + size, 0x1);
+
+    barrier();
+
+    base = h;
+
+    trace (TRACE_CPU, "TRACE: %#010lx+%#zx (%u records per CPU)", phys, size, RECORDS);
+}
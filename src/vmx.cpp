@@ -156,8 +156,10 @@ void Vmcs::init()
         ctrl_cpu[1].val = Msr::read<uint64>(Msr::IA32_VMX_CTRL_CPU1);
     if (has_ept() || has_vpid())
         ept_vpid.val = Msr::read<uint64>(Msr::IA32_VMX_EPT_VPID);
+
+    /* Ept::ord = min (Ept::ord, n) with other APs racing, the rest is CPU-local */
     if (has_ept())
-        Ept::ord = min (Ept::ord, static_cast<mword>(bit_scan_reverse (static_cast<mword>(ept_vpid.super)) + 2) * Ept::bpl() - 1);
+        for (mword o, n = static_cast<mword>(bit_scan_reverse (static_cast<mword>(ept_vpid.super)) + 2) * Ept::bpl() - 1; (o = Ept::ord) > n && !Atomic::cmp_swap (Ept::ord, o, n); pause()) ;
     if (has_urg())
         fix_cr0_set &= ~(Cpu::CR0_PG | Cpu::CR0_PE);
 
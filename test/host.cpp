@@ -0,0 +1,65 @@
+/*
+ * Host Stand-ins
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "console.hpp"
+#include "cpu.hpp"
+#include "memory.hpp"
+#include "pd.hpp"
+
+unsigned    Cpu::id;
+bool        Cpu::preemption;
+
+Pd *        Pd::current = &Pd::kern;
+Pd          Pd::kern, Pd::root;
+
+void Console::print (char const *format, ...)
+{
+    va_list args;
+    va_start (args, format);
+    ::vprintf (format, args);
+    va_end (args);
+
+    putchar ('\n');
+}
+
+void Console::panic (char const *format, ...)
+{
+    va_list args;
+    va_start (args, format);
+    ::vprintf (format, args);
+    va_end (args);
+
+    putchar ('\n');
+
+    abort();
+}
+
+/*
+ * Memory of the buddy allocator, which the kernel linker script provides.
+ * Physical addresses equal virtual ones.
+ */
+#define POOL_SIZE   0x4000000
+
+extern "C" { ALIGNED (PAGE_SIZE) char host_pool[POOL_SIZE]; }
+
+asm (".globl _mempool_p, _mempool_l, _mempool_f, _mempool_e, OFFSET\n"
+     ".set _mempool_p, host_pool\n"
+     ".set _mempool_l, host_pool\n"
+     ".set _mempool_f, host_pool\n"
+     ".set _mempool_e, host_pool + " EXPAND (POOL_SIZE) "\n"
+     ".set OFFSET, 0\n");
@@ -0,0 +1,42 @@
+/*
+ * Host Stand-in: Central Processing Unit (CPU)
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "compiler.hpp"
+#include "config.hpp"
+#include "types.hpp"
+#include "assert.hpp"
+#include "macros.hpp"
+
+/*
+ * A single CPU that runs with preemption disabled, so that Lock_guard
+ * never touches the interrupt flag.
+ */
+class Cpu
+{
+    public:
+        static unsigned id;
+        static bool     preemption;
+
+        ALWAYS_INLINE
+        static inline void preempt_disable() { preemption = false; }
+
+        ALWAYS_INLINE
+        static inline void preempt_enable() { preemption = true; }
+
+        ALWAYS_INLINE
+        static inline bool preempt_status() { return preemption; }
+};
@@ -0,0 +1,27 @@
+/*
+ * Host Build Prelude
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "compiler.hpp"
+
+/*
+ * Included ahead of every host-built source. Code placed in the kernel's
+ * .init section would end up inside the host's startup code.
+ */
+#undef  INIT
+#define INIT
+#undef  INITDATA
+#define INITDATA
@@ -0,0 +1,30 @@
+/*
+ * Host Stand-in: Protection Domain (PD)
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "quota.hpp"
+
+/*
+ * Only the quota of a PD is used by the code under test.
+ */
+class Pd
+{
+    public:
+        static Pd *current;
+        static Pd kern, root;
+
+        Quota quota { };
+};
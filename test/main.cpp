@@ -0,0 +1,66 @@
+/*
+ * Host Test Harness
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include <stdio.h>
+
+#include "string.hpp"
+#include "test.hpp"
+
+Test *      Test::list;
+Test **     Test::tail = &Test::list;
+unsigned    Test::failed;
+
+bool Test::run (bool b)
+{
+    for (Test *t = list; t; t = t->next) {
+
+        if (t->bench != b)
+            continue;
+
+        unsigned const f = failed;
+
+        t->func();
+
+        if (!b)
+            printf ("%s %s\n", f == failed ? "PASS" : "FAIL", t->name);
+    }
+
+    if (!b)
+        printf ("%u check(s) failed\n", failed);
+
+    return !failed;
+}
+
+void Test::check (bool ok, char const *expr, char const *file, int line)
+{
+    if (ok)
+        return;
+
+    failed++;
+
+    printf ("%s:%d: check \"%s\" failed\n", file, line, expr);
+}
+
+void Test::report (char const *what, uint64 cycles, unsigned long ops)
+{
+    printf ("%-32s %10llu cycles/op\n", what, static_cast<unsigned long long>(cycles / ops));
+}
+
+int main (int argc, char **argv)
+{
+    bool const bench = argc > 1 && strmatch (argv[1], "bench", sizeof ("bench") - 1);
+
+    return Test::run (bench) ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+/*
+ * Host Test Harness
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "barrier.hpp"
+#include "compiler.hpp"
+#include "types.hpp"
+#include "x86.hpp"
+
+/*
+ * Tests and benchmarks register themselves at static construction time
+ * and run in the order of their definition within a file. Benchmarks
+ * only run on request and report the TSC cycles per operation.
+ */
+class Test
+{
+    private:
+        static Test *   list;
+        static Test **  tail;
+        static unsigned failed;
+
+        Test *          next;
+        char const *    name;
+        void            (*func)();
+        bool            bench;
+
+        Test (Test const &);
+        Test &operator = (Test const &);
+
+    public:
+        Test (char const *n, void (*f)(), bool b) : next (nullptr), name (n), func (f), bench (b)
+        {
+            *tail = this;
+            tail  = &next;
+        }
+
+        static bool run (bool);
+
+        static void check (bool, char const *, char const *, int);
+
+        static void report (char const *, uint64, unsigned long);
+};
+
+/*
+ * Deterministic pseudo-random numbers (xorshift)
+ */
+class Random
+{
+    private:
+        uint64 s;
+
+    public:
+        explicit Random (uint64 seed = 0x9e3779b97f4a7c15ULL) : s (seed) { }
+
+        ALWAYS_INLINE
+        inline uint64 next()
+        {
+            s ^= s << 13;
+            s ^= s >> 7;
+            s ^= s << 17;
+            return s;
+        }
+};
+
+#define TEST(N)     static void test_##N();                                 \
+                    static Test test_reg_##N (#N, test_##N, false);         \
+                    static void test_##N()
+
+#define BENCH(N)    static void bench_##N();                                \
+                    static Test bench_reg_##N (#N, bench_##N, true);        \
+                    static void bench_##N()
+
+#define CHECK(X)    Test::check (!!(X), #X, __FILE__, __LINE__)
+
+/*
+ * Runs X n times and reports the cycles per run. The barrier keeps the
+ * compiler from merging or eliding the memory effects of iterations.
+ */
+#define MEASURE(W,n,X)  do {                                                \
+                            uint64 const t = rdtsc();                       \
+                            for (unsigned long i = 0; i < (n); i++) {       \
+                                X;                                          \
+                                barrier();                                  \
+                            }                                               \
+                            Test::report (W, rdtsc() - t, (n));             \
+                        } while (0)
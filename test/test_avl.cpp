@@ -0,0 +1,193 @@
+/*
+ * Host Tests: AVL Tree and Mapping Database
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "mdb.hpp"
+#include "test.hpp"
+
+/*
+ * Mapping database node with access to the tree structure
+ */
+class Node : public Mdb
+{
+    public:
+        Node (mword b, mword a = 0x1f, uint16 d = 0) : Mdb (nullptr, nullptr, 0, b, 0, a, 0, 0, d) { }
+
+        /* height of a balanced subtree or -1 */
+        static int height (Avl *a)
+        {
+            if (!a)
+                return 0;
+
+            Node *n = static_cast<Node *>(a);
+
+            int const l = height (n->lnk[0]), r = height (n->lnk[1]);
+
+            if (l < 0 || r < 0 || l - r > 1 || r - l > 1)
+                return -1;
+
+            return (l > r ? l : r) + 1;
+        }
+};
+
+static Slab_cache cache (sizeof (Node), 16);
+
+static unsigned const NODES = 4096;
+
+static Node *node[NODES];
+
+static void build (Avl *&tree, Quota &q, Random &r)
+{
+    for (unsigned i = 0; i < NODES; i++)
+        while (!Avl::insert<Mdb> (&tree, node[i] = new (q, cache) Node (r.next() >> 16)))
+            Mdb::destroy (static_cast<Mdb *>(node[i]), q, cache);
+}
+
+static void destroy (Quota &q)
+{
+    for (unsigned i = 0; i < NODES; i++)
+        if (node[i])
+            Mdb::destroy (static_cast<Mdb *>(node[i]), q, cache);
+
+    cache.free (q);
+}
+
+TEST (avl_insert)
+{
+    Quota q;
+    Random r;
+    Avl *tree = nullptr;
+
+    build (tree, q, r);
+
+    int const h = Node::height (tree);
+
+    /* an AVL tree of n nodes is at most 1.44 log2 (n + 2) high */
+    CHECK (h > 0 && h <= 18);
+
+    unsigned missing = 0;
+    for (unsigned i = 0; i < NODES; i++)
+        missing += Mdb::lookup (tree, node[i]->node_base, false) != node[i];
+
+    CHECK (!missing);
+
+    CHECK (!Avl::insert<Mdb> (&tree, node[0]));
+
+    destroy (q);
+}
+
+TEST (avl_remove)
+{
+    Quota q;
+    Random r (42);
+    Avl *tree = nullptr;
+
+    build (tree, q, r);
+
+    for (unsigned i = 0; i < NODES; i += 2)
+        CHECK (Avl::remove<Mdb> (&tree, node[i]));
+
+    CHECK (Node::height (tree) > 0);
+
+    unsigned wrong = 0;
+    for (unsigned i = 0; i < NODES; i++) {
+        Mdb *m = Mdb::lookup (tree, node[i]->node_base, false);
+        wrong += i & 1 ? m != node[i] : m != nullptr;
+    }
+
+    CHECK (!wrong);
+
+    CHECK (!Avl::remove<Mdb> (&tree, node[0]));
+
+    destroy (q);
+}
+
+TEST (mdb_lookup_next)
+{
+    Quota q;
+    Avl *tree = nullptr;
+
+    Node *a = new (q, cache) Node (0x100), *b = new (q, cache) Node (0x300);
+
+    Avl::insert<Mdb> (&tree, a);
+    Avl::insert<Mdb> (&tree, b);
+
+    CHECK (Mdb::lookup (tree, 0x200, false) == nullptr);
+    CHECK (Mdb::lookup (tree, 0x200, true) == b);
+    CHECK (Mdb::lookup (tree, 0x0ff, true) == a);
+    CHECK (Mdb::lookup (tree, 0x301, true) == nullptr);
+    CHECK (Mdb::lookup (tree, 0x300, false, true) == b);
+
+    Mdb::destroy (static_cast<Mdb *>(a), q, cache);
+    Mdb::destroy (static_cast<Mdb *>(b), q, cache);
+    cache.free (q);
+}
+
+TEST (mdb_node)
+{
+    Quota q;
+
+    Node *p = new (q, cache) Node (0, 0x7);
+    Node *c = new (q, cache) Node (0, 0, 1);
+    Node *g = new (q, cache) Node (0, 0, 2);
+
+    CHECK (c->insert_node (p, 0x3));
+    CHECK (c->node_attr == 0x3);
+    CHECK (g->insert_node (c, 0x1));
+    CHECK (p->next == c && c->next == g && g->next == p);
+
+    /* nodes with rights or children stay */
+    CHECK (!c->remove_node());
+    c->demote_node (0x3);
+    CHECK (!c->remove_node());
+
+    g->demote_node (0x1);
+    CHECK (g->remove_node());
+    CHECK (c->remove_node());
+    CHECK (p->next == p && p->prev == p);
+
+    /* kept attributes are granted beyond the parent's */
+    CHECK (c->insert_node (p, 0x12, 0x10));
+    CHECK (c->node_attr == 0x12);
+    c->demote_node (0x12);
+    CHECK (c->remove_node());
+
+    /* no insertion below a removed node */
+    CHECK (!g->insert_node (c, 0x1));
+
+    Mdb::destroy (static_cast<Mdb *>(p), q, cache);
+    Mdb::destroy (static_cast<Mdb *>(c), q, cache);
+    Mdb::destroy (static_cast<Mdb *>(g), q, cache);
+    cache.free (q);
+}
+
+BENCH (avl)
+{
+    Quota q;
+    Avl *tree = nullptr;
+
+    /* distinct keys in random order, removed nodes cannot be reinserted */
+    for (unsigned i = 0; i < NODES; i++)
+        node[i] = new (q, cache) Node (i * 0x9e3779b1U);
+
+    MEASURE ("avl insert (4096 nodes)", NODES, Avl::insert<Mdb> (&tree, node[i]));
+
+    MEASURE ("mdb lookup (4096 nodes)", 1000000, Mdb::lookup (tree, node[i % NODES]->node_base, false));
+
+    MEASURE ("mdb lookup lockless", 1000000, Mdb::lookup (tree, node[i % NODES]->node_base, false, true));
+
+    MEASURE ("avl remove (4096 nodes)", NODES, Avl::remove<Mdb> (&tree, node[i]));
+
+    destroy (q);
+}
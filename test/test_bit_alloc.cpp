@@ -0,0 +1,73 @@
+/*
+ * Host Tests: Bit Allocator
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "bit_alloc.hpp"
+#include "test.hpp"
+
+/* zero-initialized like the kernel instances */
+static Bit_alloc<256, 0>    ba_test, ba_reserve;
+static Bit_alloc<4096, 0>   ba_bench;
+
+TEST (bit_alloc)
+{
+    Bit_alloc<256, 0> &b = ba_test;
+
+    CHECK (b.alloc() == 1);
+    CHECK (b.alloc() == 2);
+
+    b.release (1);
+    b.release (0);
+
+    /* 254 ids remain, the invalid id is never handed out */
+    unsigned long inv = 0;
+    for (mword i = 2; i < b.max(); i++)
+        inv += b.alloc() == 0;
+
+    CHECK (!inv);
+    CHECK (b.alloc() == 0);
+
+    b.release (200);
+
+    CHECK (b.alloc() == 200);
+}
+
+TEST (bit_alloc_reserve)
+{
+    Bit_alloc<256, 0> &b = ba_reserve;
+
+    b.reserve (1, 100);
+
+    CHECK (b.alloc() == 101);
+
+    b.reserve (250, 100);
+    b.reserve (102, 148);
+
+    CHECK (b.alloc() == 0);
+
+    b.release (150);
+
+    CHECK (b.alloc() == 150);
+}
+
+BENCH (bit_alloc)
+{
+    Bit_alloc<4096, 0> &b = ba_bench;
+
+    MEASURE ("bit alloc+release", 1000000, b.release (b.alloc()));
+
+    MEASURE ("bit alloc 4095", 4095, b.alloc());
+
+    MEASURE ("bit release 4095", 4095, b.release (i + 1));
+}
@@ -0,0 +1,134 @@
+/*
+ * Host Tests: Buddy Allocator
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "buddy.hpp"
+#include "test.hpp"
+
+static bool filled (void const *p, unsigned short ord, unsigned char v)
+{
+    unsigned char const *c = static_cast<unsigned char const *>(p);
+
+    for (mword i = 0; i < static_cast<mword>(PAGE_SIZE) << ord; i++)
+        if (c[i] != v)
+            return false;
+
+    return true;
+}
+
+TEST (buddy_alloc)
+{
+    Quota q;
+    void *p[8];
+
+    for (unsigned short o = 0; o < 8; o++) {
+        p[o] = Buddy::allocator.alloc (o, q, Buddy::FILL_0);
+
+        CHECK (p[o]);
+        CHECK (!(Buddy::ptr_to_phys (p[o]) & ((PAGE_SIZE << o) - 1)));
+        CHECK (filled (p[o], o, 0));
+    }
+
+    CHECK (q.usage() == 255);
+
+    for (unsigned o = 0; o < 8; o++)
+        Buddy::allocator.free (reinterpret_cast<mword>(p[o]), q);
+
+    CHECK (!q.usage());
+}
+
+TEST (buddy_fill)
+{
+    Quota q;
+
+    void *p = Buddy::allocator.alloc (2, q, Buddy::FILL_1);
+
+    CHECK (filled (p, 2, 0xff));
+
+    Buddy::allocator.free (reinterpret_cast<mword>(p), q);
+
+    p = Buddy::allocator.alloc (2, q, Buddy::FILL_0);
+
+    CHECK (filled (p, 2, 0));
+
+    Buddy::allocator.free (reinterpret_cast<mword>(p), q);
+}
+
+TEST (buddy_kind)
+{
+    Quota q;
+
+    void *u = Buddy::allocator.alloc (0, q, Buddy::NOFILL, Quota::KIND_UTCB);
+    void *v = Buddy::allocator.alloc (1, q, Buddy::NOFILL, Quota::KIND_VCPU);
+
+    CHECK (q.usage() == 3);
+    CHECK (q.usage (Quota::KIND_UTCB) == 1);
+    CHECK (q.usage (Quota::KIND_VCPU) == 2);
+
+    Quota to;
+    q.free_up (to);
+
+    CHECK (!q.usage (Quota::KIND_VCPU));
+    CHECK (to.usage (Quota::KIND_VCPU) == 2);
+
+    Buddy::allocator.free (reinterpret_cast<mword>(u), to, Quota::KIND_UTCB);
+    Buddy::allocator.free (reinterpret_cast<mword>(v), to, Quota::KIND_VCPU);
+
+    CHECK (!to.usage());
+    CHECK (!to.usage (Quota::KIND_UTCB));
+}
+
+/*
+ * Freed pages merge with their buddies: once most of the pool has been
+ * handed out page by page and returned, large blocks are available again
+ */
+TEST (buddy_merge)
+{
+    static void *p[56 << (20 - PAGE_BITS)];   // 56 of the 64 MiB pool
+
+    Quota q;
+
+    for (unsigned i = 0; i < sizeof (p) / sizeof (*p); i++)
+        p[i] = Buddy::allocator.alloc (0, q, Buddy::NOFILL);
+
+    for (unsigned i = 0; i < sizeof (p) / sizeof (*p); i++)
+        Buddy::allocator.free (reinterpret_cast<mword>(p[i]), q);
+
+    mword const b = reinterpret_cast<mword>(Buddy::allocator.alloc (12, q, Buddy::NOFILL));
+
+    CHECK (!(Buddy::ptr_to_phys (reinterpret_cast<void *>(b)) & ((PAGE_SIZE << 12) - 1)));
+
+    Buddy::allocator.free (b, q);
+
+    CHECK (!q.usage());
+}
+
+BENCH (buddy)
+{
+    Quota q;
+    static void *p[1024];
+
+    MEASURE ("buddy alloc+free order 0", 100000,
+             Buddy::allocator.free (reinterpret_cast<mword>(Buddy::allocator.alloc (0, q, Buddy::NOFILL)), q));
+
+    MEASURE ("buddy alloc+free order 4", 100000,
+             Buddy::allocator.free (reinterpret_cast<mword>(Buddy::allocator.alloc (4, q, Buddy::NOFILL)), q));
+
+    MEASURE ("buddy alloc 1024 pages", 1024, p[i] = Buddy::allocator.alloc (0, q, Buddy::NOFILL));
+
+    MEASURE ("buddy free 1024 pages", 1024, Buddy::allocator.free (reinterpret_cast<mword>(p[i]), q));
+
+    MEASURE ("buddy alloc+free zeroed page", 10000,
+             Buddy::allocator.free (reinterpret_cast<mword>(Buddy::allocator.alloc (0, q, Buddy::FILL_0)), q));
+}
@@ -0,0 +1,102 @@
+/*
+ * Host Tests: Page Tables
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "ept.hpp"
+#include "test.hpp"
+
+static mword const ATTR = Ept::hw_attr (Ept::EPT_R | Ept::EPT_W | Ept::EPT_X, 6);
+
+TEST (pte_update)
+{
+    Quota q;
+    Ept ept;
+    Paddr p;
+    mword a;
+
+    CHECK (!ept.lookup (0x1000, p, a));
+
+    ept.update (q, 0x1000, 0, 0x5000, ATTR);
+
+    /* root and one table per level */
+    CHECK (ept.pages() == 4);
+    CHECK (q.usage() == 4 && q.usage (Ept::KIND) == 4);
+
+    CHECK (ept.lookup (0x1234, p, a) == PAGE_SIZE);
+    CHECK (p == 0x5234 && a == ATTR);
+
+    ept.update (q, 0x200000, 9, 0x400000, ATTR);
+
+    CHECK (ept.pages() == 4);
+    CHECK (ept.lookup (0x3fffff, p, a) == 0x200000);
+    CHECK (p == 0x5fffff);
+
+    /* a superpage replaces the page table below it */
+    CHECK (ept.update (q, 0, 9, 0x800000, ATTR));
+    CHECK (ept.pages() == 3);
+    CHECK (q.usage() == 3 && q.usage (Ept::KIND) == 3);
+    CHECK (ept.lookup (0x1000, p, a) == 0x200000 && p == 0x801000);
+
+    ept.update (q, 0, 9, 0, 0, Ept::TYPE_DN);
+
+    CHECK (!ept.lookup (0x1000, p, a));
+    CHECK (ept.lookup (0x200000, p, a));
+
+    ept.clear (q);
+
+    CHECK (!q.usage() && !q.usage (Ept::KIND));
+}
+
+TEST (pte_range)
+{
+    Quota q;
+    Ept ept;
+    Paddr p;
+    mword a;
+
+    /* 8 pages in one go, recorded with their order */
+    ept.update (q, 0x10000, 3, 0x20000, ATTR);
+
+    unsigned long wrong = 0;
+    for (mword v = 0x10000; v < 0x18000; v += PAGE_SIZE)
+        wrong += ept.lookup (v, p, a) != PAGE_SIZE << 3 || p != v + 0x10000;
+
+    CHECK (!wrong);
+    CHECK (!ept.lookup (0x18000, p, a));
+
+    ept.clear (q);
+
+    CHECK (!q.usage());
+}
+
+BENCH (pte)
+{
+    Quota q;
+    Ept ept;
+    Paddr p;
+    mword a;
+
+    for (mword v = 0; v < 0x200000; v += PAGE_SIZE)
+        ept.update (q, v, 0, v, ATTR);
+
+    MEASURE ("ept lookup 4K", 1000000, ept.lookup ((i % 512) << PAGE_BITS, p, a));
+
+    MEASURE ("ept update 4K", 1000000, ept.update (q, (i % 512) << PAGE_BITS, 0, i << PAGE_BITS, ATTR));
+
+    ept.update (q, 0x40000000, 18, 0x40000000, ATTR);
+
+    MEASURE ("ept lookup 1G", 1000000, ept.lookup (0x40000000 + (i << PAGE_BITS), p, a));
+
+    ept.clear (q);
+}
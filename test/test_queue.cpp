@@ -0,0 +1,92 @@
+/*
+ * Host Tests: Queues and RCU Lists
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "queue.hpp"
+#include "rcu.hpp"
+#include "test.hpp"
+
+class Elem
+{
+    public:
+        Elem *      prev { nullptr };
+        Elem *      next { nullptr };
+        unsigned    id   { 0 };
+};
+
+TEST (queue)
+{
+    static Elem e[4];
+    Queue<Elem> q;
+
+    CHECK (!q.head());
+
+    for (unsigned i = 0; i < 4; i++) {
+        e[i].id = i;
+        q.enqueue (e + i);
+    }
+
+    unsigned n = 0, order = 0;
+    q.for_each ([&] (Elem &x) { order = order * 10 + x.id; n++; });
+
+    CHECK (n == 4 && order == 123);
+
+    CHECK (q.dequeue (e));
+    CHECK (q.head() == e + 1);
+    CHECK (!q.dequeue (e));
+
+    CHECK (q.dequeue (e + 2));
+    CHECK (e[1].next == e + 3 && e[3].prev == e + 1);
+
+    CHECK (q.dequeue (e + 1));
+    CHECK (q.dequeue (e + 3));
+    CHECK (!q.head());
+}
+
+TEST (rcu_list)
+{
+    Rcu_elem a (nullptr), b (nullptr), c (nullptr);
+    Rcu_list l, m;
+
+    CHECK (l.empty());
+
+    CHECK (l.enqueue (&a));
+    CHECK (l.enqueue (&b));
+    CHECK (l.count == 2 && !l.empty());
+
+    /* an element sits in at most one list */
+    CHECK (!l.enqueue (&a));
+    CHECK (!m.enqueue (&b));
+
+    CHECK (m.enqueue (&c));
+
+    l.append (&m);
+
+    CHECK (l.count == 3 && m.empty() && !m.count);
+    CHECK (l.head == &a && a.next == &b && b.next == &c);
+}
+
+static Queue<Elem> queue;
+
+BENCH (queue)
+{
+    static Elem e[1024];
+    Queue<Elem> &q = queue;
+
+    MEASURE ("queue enqueue+dequeue", 1000000, q.enqueue (e); q.dequeue (e));
+
+    MEASURE ("queue enqueue 1024", 1024, q.enqueue (e + i));
+
+    MEASURE ("queue dequeue 1024", 1024, q.dequeue (e + i));
+}
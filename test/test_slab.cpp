@@ -0,0 +1,81 @@
+/*
+ * Host Tests: Slab Allocator
+ *
+ * This file is part of the NOVA microhypervisor.
+ *
+ * NOVA is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * NOVA is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "slab.hpp"
+#include "test.hpp"
+
+TEST (slab_alloc)
+{
+    Quota q;
+    Slab_cache c (40, 16);
+
+    unsigned long const n = 3 * c.elem;
+    static void *p[PAGE_SIZE];
+
+    for (unsigned long i = 0; i < n; i++) {
+        p[i] = c.alloc (q);
+
+        CHECK (!(reinterpret_cast<mword>(p[i]) & 15));
+    }
+
+    CHECK (c.pages == 3);
+    CHECK (q.usage() == 3);
+
+    unsigned long dup = 0;
+    for (unsigned long i = 1; i < n; i++)
+        dup += p[i] == p[i - 1];
+
+    CHECK (!dup);
+
+    for (unsigned long i = 0; i < n; i++)
+        c.free (p[i], q);
+
+    /* one empty slab is kept */
+    CHECK (c.pages == 1);
+
+    c.free (q);
+
+    CHECK (!c.pages);
+    CHECK (!q.usage());
+}
+
+TEST (slab_reuse)
+{
+    Quota q;
+    Slab_cache c (sizeof (mword), sizeof (mword));
+
+    void *p = c.alloc (q);
+    c.free (p, q);
+
+    CHECK (c.alloc (q) == p);
+
+    c.free (p, q);
+    c.free (q);
+}
+
+BENCH (slab)
+{
+    Quota q;
+    Slab_cache c (128, 32);
+    static void *p[4096];
+
+    MEASURE ("slab alloc+free", 100000, c.free (c.alloc (q), q));
+
+    MEASURE ("slab alloc 4096", 4096, p[i] = c.alloc (q));
+
+    MEASURE ("slab free 4096", 4096, c.free (p[i], q));
+
+    c.free (q);
+}